@@ -0,0 +1,324 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#include "sort_registry.h"
+#include "sort_traits.h"
+#include "advanced_sorts.h"
+#include "radix_sorts.h"
+
+using namespace std;
+
+// ------------------------------
+// Key Range Probe
+// ------------------------------
+const size_t DISTINCT_SKETCH_BITS = 1 << 14; // Bitmap size for the linear-counting distinct estimate
+const size_t DISTINCT_SAMPLE_SIZE = 1 << 13;  // Keys hashed into the bitmap
+
+struct KeyRangeProfile {
+    long long minKey = 0;
+    long long maxKey = 0;
+    size_t range = 0;            // maxKey - minKey + 1 (saturates at SIZE_MAX)
+    size_t distinctEstimate = 0; // Linear-counting estimate of distinct keys in a sample (exact after counting sort)
+};
+
+// One pass over the input for min and max, plus a distinct-key estimate from a strided sample
+template <typename RandomIt, typename KeyFn>
+KeyRangeProfile probeKeyRange(RandomIt first, RandomIt last, KeyFn key) {
+    KeyRangeProfile p;
+    if (first == last) return p;
+
+    auto lo = key(*first), hi = lo;
+    for (RandomIt it = first; it != last; ++it) {
+        auto k = key(*it);
+        lo = min(lo, k);
+        hi = max(hi, k);
+    }
+
+    // Hashing every key would cost more than the min/max scan, so only a sample feeds the sketch
+    size_t n = last - first;
+    size_t stride = max<size_t>(1, n / DISTINCT_SAMPLE_SIZE);
+    bitset<DISTINCT_SKETCH_BITS> seen;
+    for (size_t i = 0; i < n; i += stride) {
+        // splitmix64 finalizer: consecutive keys must land in independent-looking slots
+        uint64_t h = static_cast<uint64_t>(radixOrderedKey(key(first[i])));
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+        h ^= h >> 31;
+        seen.set(h & (DISTINCT_SKETCH_BITS - 1));
+    }
+
+    p.minKey = static_cast<long long>(lo);
+    p.maxKey = static_cast<long long>(hi);
+    auto span = radixOrderedKey(hi) - radixOrderedKey(lo);
+    p.range = span >= SIZE_MAX ? SIZE_MAX : static_cast<size_t>(span) + 1;
+
+    // Linear counting: m * ln(m / empty slots)
+    size_t empty = DISTINCT_SKETCH_BITS - seen.count();
+    double m = DISTINCT_SKETCH_BITS;
+    p.distinctEstimate = empty == 0 ? DISTINCT_SKETCH_BITS
+                                    : static_cast<size_t>(m * log(m / empty) + 0.5);
+    return p;
+}
+
+// ------------------------------
+// Adaptive Sort (Stable)
+// ------------------------------
+const size_t COUNTING_SORT_MAX_RANGE = 1 << 20; // Largest key range worth a counting array
+
+// Which path the last AdaptiveSort call took, for the benchmark harness
+struct AdaptiveSortReport {
+    string path;
+    KeyRangeProfile profile;
+};
+
+inline AdaptiveSortReport& lastAdaptiveSortReport() {
+    static AdaptiveSortReport report;
+    return report;
+}
+
+// Routes small key ranges (range <= n, so O(n + k) is linear) to counting sort and
+// everything else to TimSort. Both paths are stable.
+template <typename RandomIt, typename KeyFn = FirstKey>
+void AdaptiveSort(RandomIt first, RandomIt last, KeyFn key = {}) {
+    using K = decay_t<decltype(key(*first))>;
+    static_assert(is_integral<K>::value, "AdaptiveSort needs an integral key");
+    size_t n = last - first;
+
+    KeyRangeProfile profile = probeKeyRange(first, last, key);
+    AdaptiveSortReport& report = lastAdaptiveSortReport();
+    report.profile = profile;
+
+    if (n >= 2 && profile.range <= max<size_t>(n, 256) && profile.range <= COUNTING_SORT_MAX_RANGE) {
+        report.path = "Counting Sort";
+        report.profile.distinctEstimate = CountingSort(first, last, static_cast<K>(profile.minKey), profile.range, key);
+    } else {
+        report.path = "Tim Sort";
+        TimSort(first, last, key);
+    }
+}
+
+inline void AdaptiveSort(vector<pair<int, int>>& arr) {
+    AdaptiveSort(arr.begin(), arr.end());
+}
+REGISTER_RANGE_SORT(AdaptiveSort, "Adaptive Sort", 2, AdaptiveSort);
+
+// ------------------------------
+// Input Shape Probe
+// ------------------------------
+const size_t SHAPE_WINDOWS = 64;       // Windows of consecutive records probed for run structure
+const size_t SHAPE_WINDOW_LENGTH = 16; // Records per window
+const size_t SHAPE_SAMPLE_SIZE = 512;  // Evenly strided keys probed for disorder, key range and repeats
+
+struct InputShape {
+    double descentRate = 0;    // Share of adjacent pairs in the windows that descend: ~0 in ascending runs, ~0.5 random
+    double ascentRate = 0;     // Share that ascend (equal neighbours count as neither)
+    double inversionRatio = 0; // Share of inverted pairs in the sample: 0 sorted, ~0.5 random, 1 reversed
+    double rangeRatio = 0;     // Sampled key range / n, a lower bound on the true ratio
+    double duplicateRatio = 0; // Share of sampled keys equal to another sampled key
+};
+
+// Sorts keys[0, m) (buf is scratch) with a bottom-up merge sort and returns the number of inverted pairs
+template <typename K>
+uint64_t sortCountingInversions(K* keys, K* buf, size_t m) {
+    uint64_t inversions = 0;
+    for (size_t width = 1; width < m; width *= 2) {
+        for (size_t lo = 0; lo < m; lo += 2 * width) {
+            size_t mid = min(lo + width, m), hi = min(lo + 2 * width, m);
+            size_t i = lo, j = mid, out = lo;
+            while (i < mid && j < hi) {
+                if (keys[j] < keys[i]) {
+                    inversions += mid - i; // keys[j] jumps every key left in the first half
+                    buf[out++] = keys[j++];
+                } else {
+                    buf[out++] = keys[i++];
+                }
+            }
+            out = copy(keys + i, keys + mid, buf + out) - buf;
+            copy(keys + j, keys + hi, buf + out);
+        }
+        copy(buf, buf + m, keys);
+    }
+    return inversions;
+}
+
+// Reads a fixed number of records whatever n: SHAPE_WINDOWS windows for run structure and a strided
+// sample of SHAPE_SAMPLE_SIZE keys for the rest, so the probe stays a rounding error next to the sort
+template <typename RandomIt, typename KeyFn>
+InputShape probeInputShape(RandomIt first, RandomIt last, KeyFn key) {
+    using K = decay_t<decltype(key(*first))>;
+    InputShape shape;
+    size_t n = last - first;
+    if (n < 2) return shape;
+
+    // Run structure: adjacent pairs inside evenly spaced windows (one window covering short inputs)
+    size_t windows = n <= SHAPE_WINDOWS * SHAPE_WINDOW_LENGTH ? 1 : SHAPE_WINDOWS;
+    size_t length = windows == 1 ? n : SHAPE_WINDOW_LENGTH;
+    size_t pairs = 0, descents = 0, ascents = 0;
+    for (size_t w = 0; w < windows; ++w) {
+        size_t start = windows == 1 ? 0 : w * (n - length) / (windows - 1);
+        for (size_t i = start; i + 1 < start + length; ++i) {
+            K a = key(first[i]), b = key(first[i + 1]);
+            descents += b < a;
+            ascents += a < b;
+            ++pairs;
+        }
+    }
+    shape.descentRate = static_cast<double>(descents) / pairs;
+    shape.ascentRate = static_cast<double>(ascents) / pairs;
+
+    // Disorder, range and repeats from the strided sample, sorted while its inversions are counted
+    size_t m = min(n, SHAPE_SAMPLE_SIZE);
+    array<K, SHAPE_SAMPLE_SIZE> sample, buf;
+    for (size_t s = 0; s < m; ++s) sample[s] = key(first[s * n / m]);
+    uint64_t inversions = sortCountingInversions(sample.data(), buf.data(), m);
+    shape.inversionRatio = inversions / (m * (m - 1) / 2.0);
+    shape.rangeRatio = (static_cast<double>(radixOrderedKey(sample[m - 1]) - radixOrderedKey(sample[0])) + 1) / n;
+    size_t repeats = 0;
+    for (size_t s = 0; s < m; ++s)
+        repeats += (s > 0 && sample[s] == sample[s - 1]) || (s + 1 < m && sample[s] == sample[s + 1]);
+    shape.duplicateRatio = static_cast<double>(repeats) / m;
+    return shape;
+}
+
+// ------------------------------
+// Auto Sort (Unstable)
+// ------------------------------
+// Probes the input's shape and hands it to the engine that wins on that shape: Tim Sort on ascending runs,
+// Intro Sort on descending ones and on heavily repeated keys, counting sort on narrow key ranges, LSD radix
+// sort on wide random keys once n is large enough, Intro Sort otherwise. The thresholds live in an
+// AutoSortProfile: the defaults come from a --tune run, and --auto-profile loads one made on the host.
+const size_t AUTO_SORT_MIN_PROBE = 2048; // Smaller inputs go straight to Intro Sort, which adapts on its own
+
+struct AutoSortProfile {
+    double runDescentRate = 0.01;    // Tim Sort when at most this share of probed neighbours descend (a few
+                                     // stray swaps in presorted input still count as runs)
+    double countingRangeRatio = 0.5; // Counting sort when the key range is at most this many times n
+    double duplicateRatio = 0.85;    // Intro Sort when at least this share of sampled keys repeat
+    size_t radixMinSize = 10000;     // LSD radix sort for wide random keys from this size on
+};
+
+inline AutoSortProfile& autoSortProfile() {
+    static AutoSortProfile profile;
+    return profile;
+}
+
+// Writes the profile as name=value lines; on failure returns false and sets error
+inline bool saveAutoSortProfile(const string& path, const AutoSortProfile& profile, string& error) {
+    ofstream out(path);
+    out << "# Auto Sort profile (AlgorithmEvaluation --tune)\n"
+        << "runDescentRate=" << profile.runDescentRate << "\n"
+        << "countingRangeRatio=" << profile.countingRangeRatio << "\n"
+        << "duplicateRatio=" << profile.duplicateRatio << "\n"
+        << "radixMinSize=" << profile.radixMinSize << "\n";
+    if (!out) error = "cannot write " + path;
+    return static_cast<bool>(out);
+}
+
+// Reads a profile written by saveAutoSortProfile; names it doesn't list keep their current values
+inline bool loadAutoSortProfile(const string& path, AutoSortProfile& profile, string& error) {
+    ifstream in(path);
+    if (!in) {
+        error = "cannot read " + path;
+        return false;
+    }
+    string line;
+    for (int lineNo = 1; getline(in, line); ++lineNo) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t eq = line.find('=');
+        string name = line.substr(0, eq), value = eq == string::npos ? "" : line.substr(eq + 1);
+        char* end = nullptr;
+        double v = strtod(value.c_str(), &end);
+        if (value.empty() || *end != '\0' || v < 0) {
+            error = path + ":" + to_string(lineNo) + ": bad line '" + line + "'";
+            return false;
+        }
+        if (name == "runDescentRate") profile.runDescentRate = v;
+        else if (name == "countingRangeRatio") profile.countingRangeRatio = v;
+        else if (name == "duplicateRatio") profile.duplicateRatio = v;
+        else if (name == "radixMinSize") profile.radixMinSize = v >= 1.8e19 ? numeric_limits<size_t>::max() : static_cast<size_t>(v);
+        else {
+            error = path + ":" + to_string(lineNo) + ": unknown setting '" + name + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Which path the last AutoSort call took, for the benchmark harness
+struct AutoSortReport {
+    string path;
+    InputShape shape;
+};
+
+inline AutoSortReport& lastAutoSortReport() {
+    static AutoSortReport report;
+    return report;
+}
+
+template <typename RandomIt, typename KeyFn = FirstKey>
+void AutoSort(RandomIt first, RandomIt last, KeyFn key = {}) {
+    using K = decay_t<decltype(key(*first))>;
+    static_assert(is_integral<K>::value, "AutoSort needs an integral key");
+    size_t n = last - first;
+    const AutoSortProfile& profile = autoSortProfile();
+    AutoSortReport& report = lastAutoSortReport();
+    report.shape = {};
+
+    if (n < AUTO_SORT_MIN_PROBE) {
+        report.path = "Intro Sort (small input)";
+        IntroSort(first, last, key);
+        return;
+    }
+    InputShape shape = probeInputShape(first, last, key);
+    report.shape = shape;
+
+    // Runs are told apart by direction: Tim Sort only reverses strictly descending runs, so descending input
+    // with repeated keys would cost it a merge per tie
+    if (shape.descentRate <= profile.runDescentRate && shape.descentRate <= shape.ascentRate) {
+        report.path = "Tim Sort (ascending runs)";
+        TimSort(first, last, key);
+        return;
+    }
+    if (shape.ascentRate <= profile.runDescentRate) {
+        report.path = "Intro Sort (descending runs)";
+        IntroSort(first, last, key);
+        return;
+    }
+
+    // The sample only bounds the range from below: a full min/max pass confirms it before counting
+    if (shape.rangeRatio <= profile.countingRangeRatio) {
+        KeyRangeProfile range = probeKeyRange(first, last, key);
+        if (range.range <= profile.countingRangeRatio * n && range.range <= COUNTING_SORT_MAX_RANGE) {
+            report.path = "Counting Sort (narrow key range)";
+            CountingSort(first, last, static_cast<K>(range.minKey), range.range, key);
+            return;
+        }
+    }
+
+    if (shape.duplicateRatio >= profile.duplicateRatio) {
+        report.path = "Intro Sort (repeated keys)";
+        IntroSort(first, last, key);
+    } else if (n >= profile.radixMinSize) {
+        report.path = "LSD Radix Sort (wide keys)";
+        LSDRadixSort(first, last, key);
+    } else {
+        report.path = "Intro Sort";
+        IntroSort(first, last, key);
+    }
+}
+
+inline void AutoSort(vector<pair<int, int>>& arr) {
+    AutoSort(arr.begin(), arr.end());
+}
+REGISTER_RANGE_SORT(AutoSort, "Auto Sort", 2, AutoSort);
@@ -1,169 +1,498 @@
 #pragma once
 #include <vector>
+#include <algorithm>
 #include <climits>
 #include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <type_traits>
+
+#include "sort_registry.h"
+#include "sort_traits.h"
+#include "basic_sorts.h"
+#include "sorting_networks.h"
 
 using namespace std;
 
 // ------------------------------
-// Library Sort (Stable, Gap-based)
+// Library Sort (Stable, Gapped Insertion Sort)
 // ------------------------------
-inline void LibrarySort(vector<pair<int, int>>& arr) {
-    const double INITIAL_GAP_RATIO = 1.5; // Initial table size is set to 1.5x the input
-    const int HARD_LIMIT = 100'000'000;   // Maximum memory limit (prevents unbounded growth)
+const double LIBRARY_SORT_GAP = 1.0; // Gap slots left per element after each rebalance (the paper's epsilon)
 
-    // Function to check if a slot is empty (INT_MAX represents empty)
-    auto isEmpty = [](const pair<int, int>& p) {
-        return p.first == INT_MAX;
-    };
+// Bender, Farach-Colton & Mosteiro: insertion sort into an array with gaps. Rounds double the element
+// count and end in a rebalance that spreads elements evenly, so shifts stay O(log n) expected.
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void LibrarySort(RandomIt first, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    const size_t EMPTY = SIZE_MAX; // Tag of an empty slot
+    auto lt = makeKeyLess(key, comp);
+    size_t n = last - first;
+    if (n < 2) return;
 
-    // Rebuilds the table with gaps inserted between elements
-    auto rebuildWithGap = [&](const vector<pair<int, int>>& active, int newCap) {
-        vector<pair<int, int>> newTable(newCap, {INT_MAX, -1});
-        if (active.empty()) return newTable;
+    // The shift bound assumes random insertion order; sorted input would otherwise pile every insert
+    // into the tail. Inserts follow a fixed shuffle and ties break on original index, keeping the sort stable.
+    vector<size_t> order(n);
+    iota(order.begin(), order.end(), size_t(0));
+    shuffle(order.begin(), order.end(), mt19937_64(n));
 
-        int slots = active.size();
-        int gapCount = newCap - slots;         // Total number of gaps to insert
-        vector<int> gaps(slots + 1, 0);        // Gaps to insert at each position
+    // Each slot holds a record and its original index as tag
+    vector<T> table, spare;
+    vector<size_t> tag, spareTag;
+    size_t count = 0;
 
-        for (int i = 0; i < gapCount; ++i)
-            gaps[i % (slots + 1)]++;           // Distribute gaps evenly
+    auto before = [&](const T& a, size_t ia, const T& b, size_t ib) {
+        return lt(a, b) || (!lt(b, a) && ia < ib);
+    };
 
-        int pos = 0;
-        for (int i = 0; i < slots; ++i) {
-            pos += gaps[i];                    
-            newTable[pos++] = active[i];       
+    // Spreads the count elements evenly over cap slots, centered in their share of the table
+    auto rebalance = [&](size_t cap) {
+        spare.resize(cap);
+        spareTag.assign(cap, EMPTY);
+        size_t j = 0;
+        for (size_t s = 0; s < table.size(); ++s) {
+            if (tag[s] == EMPTY) continue;
+            size_t pos = (2 * j + 1) * cap / (2 * count);
+            spare[pos] = std::move(table[s]);
+            spareTag[pos] = tag[s];
+            ++j;
         }
-        return newTable;
+        swap(table, spare);
+        swap(tag, spareTag);
     };
 
-    // Initialize table
-    int cap = static_cast<int>(arr.size() * INITIAL_GAP_RATIO + 1);
-    vector<pair<int, int>> table(cap, {INT_MAX, -1}); // Empty table
+    for (size_t r = 0; r < n; ++r) {
+        // A new round starts whenever the count reaches a power of two
+        if ((count & (count - 1)) == 0) {
+            size_t target = min(n, max<size_t>(2 * count, 1));
+            rebalance(static_cast<size_t>(target * (1 + LIBRARY_SORT_GAP)) + 1);
+        }
 
-    // Insertion loop
-    for (const auto& val : arr) {
-        int pos = 0;
+        size_t idx = order[r];
+        T x = std::move(first[idx]);
 
-        // Find position to insert (linear search from the front)
-        for (; pos < table.size(); ++pos) {
-            if (isEmpty(table[pos])) break;
-            if (val.first < table[pos].first) break;
-            if (val.first == table[pos].first && val.second < table[pos].second) break;
+        // Binary search for the upper bound, stepping right from each probe to the nearest occupied slot
+        size_t cap = table.size(), lo = 0, hi = cap;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2, m = mid;
+            while (m < hi && tag[m] == EMPTY) ++m;
+            if (m == hi || before(x, idx, table[m], tag[m])) hi = mid;
+            else lo = m + 1;
         }
 
-        // Linear probing to find an empty slot
-        while (pos < table.size() && !isEmpty(table[pos])) ++pos;
+        // Occupied slots before p sort before x, those from p on after it: use a gap at p or p - 1,
+        // otherwise shift the run of elements between p and the nearest gap by one
+        size_t p = lo;
+        if (p < cap && tag[p] == EMPTY) {
+        } else if (p > 0 && tag[p - 1] == EMPTY) {
+            --p;
+        } else {
+            size_t right = p;
+            while (right < cap && tag[right] != EMPTY) ++right;
+            size_t left = p;
+            while (left > 0 && tag[left - 1] != EMPTY && (right == cap || p - left < right - p)) --left;
 
-        // If table is full, expand and rebuild with new gaps
-        if (pos >= table.size()) {
-            vector<pair<int, int>> active;
-            for (auto& x : table)
-                if (!isEmpty(x)) active.push_back(x);
+            if (left > 0 && tag[left - 1] == EMPTY) {
+                move(table.begin() + left, table.begin() + p, table.begin() + left - 1);
+                move(tag.begin() + left, tag.begin() + p, tag.begin() + left - 1);
+                --p;
+            } else {
+                move_backward(table.begin() + p, table.begin() + right, table.begin() + right + 1);
+                move_backward(tag.begin() + p, tag.begin() + right, tag.begin() + right + 1);
+            }
+        }
+        table[p] = std::move(x);
+        tag[p] = idx;
+        ++count;
+    }
 
-            cap = cap * 2 + 1; // Increase capacity
-            if (cap > HARD_LIMIT) return; // Prevent excessive memory use
+    // The table is sorted: compact it back into the input
+    for (size_t s = 0, j = 0; s < table.size(); ++s)
+        if (tag[s] != EMPTY) first[j++] = std::move(table[s]);
+}
 
-            table = rebuildWithGap(active, cap);
+inline void LibrarySort(vector<pair<int, int>>& arr) {
+    LibrarySort(arr.begin(), arr.end());
+}
+REGISTER_RANGE_SORT(LibrarySort, "Library Sort", 10, LibrarySort);
 
-            // Retry insertion after rebuild
-            pos = 0;
-            for (; pos < table.size(); ++pos) {
-                if (isEmpty(table[pos])) break;
-                if (val.first < table[pos].first) break;
-                if (val.first == table[pos].first && val.second < table[pos].second) break;
-            }
-            while (pos < table.size() && !isEmpty(table[pos])) ++pos;
-            if (pos >= table.size()) return; // Still no room, give up
+// ------------------------------
+// Tim Sort (Stable)
+// ------------------------------
+const ptrdiff_t TIM_MIN_MERGE = 64;  // Inputs shorter than this are insertion sorted directly
+const ptrdiff_t TIM_MIN_GALLOP = 7;  // Consecutive wins before a merge switches to galloping
+
+// Computes minrun in [MIN_MERGE/2, MIN_MERGE] so that n / minrun is close to a power of 2
+inline ptrdiff_t timMinRunLength(ptrdiff_t n) {
+    ptrdiff_t r = 0;
+    while (n >= TIM_MIN_MERGE) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+// Finds the natural run starting at lo; strictly descending runs are reversed in place
+template <typename RandomIt, typename Less>
+ptrdiff_t timCountRunAndMakeAscending(RandomIt first, ptrdiff_t lo, ptrdiff_t hi, Less lt) {
+    ptrdiff_t runHi = lo + 1;
+    if (runHi == hi) return 1;
+
+    if (lt(first[runHi++], first[lo])) {
+        // Strictly descending (equal keys would break stability if reversed)
+        while (runHi < hi && lt(first[runHi], first[runHi - 1])) ++runHi;
+        reverse(first + lo, first + runHi);
+    } else {
+        while (runHi < hi && !lt(first[runHi], first[runHi - 1])) ++runHi;
+    }
+    return runHi - lo;
+}
+
+// Extends the sorted prefix [lo, start) to [lo, hi) by insertion.
+// A linear scan beats binary search at minrun sizes: the shift has to touch every slot anyway.
+template <typename RandomIt, typename Less>
+void timInsertionSort(RandomIt first, ptrdiff_t lo, ptrdiff_t hi, ptrdiff_t start, Less lt) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    for (; start < hi; ++start) {
+        T pivot = std::move(first[start]);
+
+        // Insert after any equal keys to stay stable
+        RandomIt pos = first + start;
+        while (pos != first + lo && lt(pivot, pos[-1])) {
+            *pos = std::move(pos[-1]);
+            --pos;
+        }
+        *pos = std::move(pivot);
+    }
+}
+
+// Leftmost position in base[0, len) at which key can be inserted (before equal keys).
+// Gallops outward from hint, then binary-searches the bracketed range.
+template <typename It, typename T, typename Less>
+ptrdiff_t timGallopLeft(const T& key, It base, ptrdiff_t len, ptrdiff_t hint, Less lt) {
+    ptrdiff_t lastOfs = 0, ofs = 1;
+    if (lt(base[hint], key)) {
+        // key > base[hint]: gallop right until base[hint + lastOfs] < key <= base[hint + ofs]
+        ptrdiff_t maxOfs = len - hint;
+        while (ofs < maxOfs && lt(base[hint + ofs], key)) {
+            lastOfs = ofs;
+            ofs = (ofs << 1) + 1;
         }
+        if (ofs > maxOfs) ofs = maxOfs;
+        lastOfs += hint;
+        ofs += hint;
+    } else {
+        // key <= base[hint]: gallop left until base[hint - ofs] < key <= base[hint - lastOfs]
+        ptrdiff_t maxOfs = hint + 1;
+        while (ofs < maxOfs && !lt(base[hint - ofs], key)) {
+            lastOfs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        if (ofs > maxOfs) ofs = maxOfs;
+        ptrdiff_t tmp = lastOfs;
+        lastOfs = hint - ofs;
+        ofs = hint - tmp;
+    }
 
-        table[pos] = val;
+    ++lastOfs;
+    while (lastOfs < ofs) {
+        ptrdiff_t m = lastOfs + (ofs - lastOfs) / 2;
+        if (lt(base[m], key)) lastOfs = m + 1;
+        else ofs = m;
     }
+    return ofs;
+}
+
+// Rightmost position in base[0, len) at which key can be inserted (after equal keys)
+template <typename It, typename T, typename Less>
+ptrdiff_t timGallopRight(const T& key, It base, ptrdiff_t len, ptrdiff_t hint, Less lt) {
+    ptrdiff_t lastOfs = 0, ofs = 1;
+    if (lt(key, base[hint])) {
+        // key < base[hint]: gallop left until base[hint - ofs] <= key < base[hint - lastOfs]
+        ptrdiff_t maxOfs = hint + 1;
+        while (ofs < maxOfs && lt(key, base[hint - ofs])) {
+            lastOfs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        if (ofs > maxOfs) ofs = maxOfs;
+        ptrdiff_t tmp = lastOfs;
+        lastOfs = hint - ofs;
+        ofs = hint - tmp;
+    } else {
+        // base[hint] <= key: gallop right until base[hint + lastOfs] <= key < base[hint + ofs]
+        ptrdiff_t maxOfs = len - hint;
+        while (ofs < maxOfs && !lt(key, base[hint + ofs])) {
+            lastOfs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        if (ofs > maxOfs) ofs = maxOfs;
+        lastOfs += hint;
+        ofs += hint;
+    }
+
+    ++lastOfs;
+    while (lastOfs < ofs) {
+        ptrdiff_t m = lastOfs + (ofs - lastOfs) / 2;
+        if (lt(key, base[m])) ofs = m;
+        else lastOfs = m + 1;
+    }
+    return ofs;
+}
+
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void TimSort(RandomIt first, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    ptrdiff_t n = last - first;
+    if (n < 2) return;
+    auto lt = makeKeyLess(key, comp);
+
+    // Small inputs: one natural run extended by insertion, no merging
+    if (n < TIM_MIN_MERGE) {
+        ptrdiff_t initRunLen = timCountRunAndMakeAscending(first, 0, n, lt);
+        if (initRunLen < n && !simdSortLeaf(first, last, lt)) timInsertionSort(first, 0, n, initRunLen, lt);
+        return;
+    }
+
+    // One scratch buffer for every merge: the smaller run is copied out, and it never exceeds n/2
+    vector<T> tmp(n / 2);
+    ptrdiff_t minGallop = TIM_MIN_GALLOP;
+
+    // Pending runs; run lengths grow at least as fast as Fibonacci, so 85 covers any 64-bit size
+    struct Run { ptrdiff_t base, len; };
+    Run runs[85];
+    int stackSize = 0;
+
+    // Merges run1 = [base1, base1+len1) (copied to tmp) with run2 from the front; requires len1 <= len2
+    auto mergeLo = [&](ptrdiff_t base1, ptrdiff_t len1, ptrdiff_t base2, ptrdiff_t len2) {
+        move(first + base1, first + base1 + len1, tmp.begin());
+        ptrdiff_t cursor1 = 0, cursor2 = base2, dest = base1;
+
+        first[dest++] = std::move(first[cursor2++]);
+        if (--len2 == 0) {
+            move(tmp.begin() + cursor1, tmp.begin() + cursor1 + len1, first + dest);
+            return;
+        }
+        if (len1 == 1) {
+            move(first + cursor2, first + cursor2 + len2, first + dest);
+            first[dest + len2] = std::move(tmp[cursor1]);
+            return;
+        }
+
+        [&] {
+            while (true) {
+                ptrdiff_t count1 = 0, count2 = 0; // Consecutive wins of each run
+
+                // One-at-a-time mode until one run wins minGallop times in a row.
+                // Written as selects rather than branches: on random input the winner is a coin flip.
+                do {
+                    bool fromRun2 = lt(first[cursor2], tmp[cursor1]);
+                    first[dest++] = std::move(fromRun2 ? first[cursor2] : tmp[cursor1]);
+                    cursor2 += fromRun2;
+                    len2 -= fromRun2;
+                    cursor1 += !fromRun2;
+                    len1 -= !fromRun2;
+                    count2 = fromRun2 ? count2 + 1 : 0;
+                    count1 = fromRun2 ? 0 : count1 + 1;
+                    if (len2 == 0 || len1 == 1) return;
+                } while ((count1 | count2) < minGallop);
+
+                // Galloping mode until neither run wins a long stretch
+                do {
+                    count1 = timGallopRight(first[cursor2], tmp.begin() + cursor1, len1, 0, lt);
+                    if (count1 != 0) {
+                        move(tmp.begin() + cursor1, tmp.begin() + cursor1 + count1, first + dest);
+                        dest += count1;
+                        cursor1 += count1;
+                        len1 -= count1;
+                        if (len1 <= 1) return;
+                    }
+                    first[dest++] = std::move(first[cursor2++]);
+                    if (--len2 == 0) return;
+
+                    count2 = timGallopLeft(tmp[cursor1], first + cursor2, len2, 0, lt);
+                    if (count2 != 0) {
+                        move(first + cursor2, first + cursor2 + count2, first + dest);
+                        dest += count2;
+                        cursor2 += count2;
+                        len2 -= count2;
+                        if (len2 == 0) return;
+                    }
+                    first[dest++] = std::move(tmp[cursor1++]);
+                    if (--len1 == 1) return;
+                    --minGallop;
+                } while (count1 >= TIM_MIN_GALLOP || count2 >= TIM_MIN_GALLOP);
 
-    // ---------- Collect results and stably sort ----------
-    vector<pair<int, int>> result;
-    for (auto& p : table)
-        if (!isEmpty(p)) result.push_back(p);
-
-    // Replace STL stable sort with manual stable insertion sort
-    auto stableSortByKey = [](vector<pair<int, int>>& a) {
-        for (int i = 1; i < a.size(); ++i) {
-            auto key = a[i];
-            int j = i - 1;
-            while (j >= 0 && (a[j].first > key.first ||
-                         (a[j].first == key.first && a[j].second > key.second))) {
-                a[j + 1] = a[j];
-                --j;
+                // Penalize leaving gallop mode
+                if (minGallop < 0) minGallop = 0;
+                minGallop += 2;
             }
-            a[j + 1] = key;
+        }();
+        if (minGallop < 1) minGallop = 1;
+
+        if (len1 == 1) {
+            move(first + cursor2, first + cursor2 + len2, first + dest);
+            first[dest + len2] = std::move(tmp[cursor1]);
+        } else {
+            move(tmp.begin() + cursor1, tmp.begin() + cursor1 + len1, first + dest);
         }
     };
-    stableSortByKey(result);
 
-    arr = result;
-}
+    // Mirror image of mergeLo: run2 is copied to tmp and merging proceeds from the back; requires len2 <= len1
+    auto mergeHi = [&](ptrdiff_t base1, ptrdiff_t len1, ptrdiff_t base2, ptrdiff_t len2) {
+        move(first + base2, first + base2 + len2, tmp.begin());
+        ptrdiff_t cursor1 = base1 + len1 - 1, cursor2 = len2 - 1, dest = base2 + len2 - 1;
 
-// ------------------------------
-// Tim Sort (Stable)
-// ------------------------------
-inline void TimSort(vector<pair<int, int>>& arr) {
-    const int RUN = 32; // Minimum run size (similar to Python's Timsort)
-    int n = arr.size();
-
-    // Sort each run using insertion sort (efficient for small segments)
-    auto insertionSort = [&](int left, int right) {
-        for (int i = left + 1; i <= right; ++i) {
-            auto key = arr[i];
-            int j = i - 1;
-
-            // Shift larger elements to the right
-            while (j >= left &&
-                   (arr[j].first > key.first ||
-                   (arr[j].first == key.first && arr[j].second > key.second))) {
-                arr[j + 1] = arr[j];
-                --j;
+        first[dest--] = std::move(first[cursor1--]);
+        if (--len1 == 0) {
+            move(tmp.begin(), tmp.begin() + len2, first + (dest - (len2 - 1)));
+            return;
+        }
+        if (len2 == 1) {
+            dest -= len1;
+            cursor1 -= len1;
+            move_backward(first + cursor1 + 1, first + cursor1 + 1 + len1, first + dest + 1 + len1);
+            first[dest] = std::move(tmp[cursor2]);
+            return;
+        }
+
+        [&] {
+            while (true) {
+                ptrdiff_t count1 = 0, count2 = 0;
+
+                do {
+                    bool fromRun1 = lt(tmp[cursor2], first[cursor1]);
+                    first[dest--] = std::move(fromRun1 ? first[cursor1] : tmp[cursor2]);
+                    cursor1 -= fromRun1;
+                    len1 -= fromRun1;
+                    cursor2 -= !fromRun1;
+                    len2 -= !fromRun1;
+                    count1 = fromRun1 ? count1 + 1 : 0;
+                    count2 = fromRun1 ? 0 : count2 + 1;
+                    if (len1 == 0 || len2 == 1) return;
+                } while ((count1 | count2) < minGallop);
+
+                do {
+                    count1 = len1 - timGallopRight(tmp[cursor2], first + base1, len1, len1 - 1, lt);
+                    if (count1 != 0) {
+                        dest -= count1;
+                        cursor1 -= count1;
+                        len1 -= count1;
+                        move_backward(first + cursor1 + 1, first + cursor1 + 1 + count1, first + dest + 1 + count1);
+                        if (len1 == 0) return;
+                    }
+                    first[dest--] = std::move(tmp[cursor2--]);
+                    if (--len2 == 1) return;
+
+                    count2 = len2 - timGallopLeft(first[cursor1], tmp.begin(), len2, len2 - 1, lt);
+                    if (count2 != 0) {
+                        dest -= count2;
+                        cursor2 -= count2;
+                        len2 -= count2;
+                        move(tmp.begin() + cursor2 + 1, tmp.begin() + cursor2 + 1 + count2, first + dest + 1);
+                        if (len2 <= 1) return;
+                    }
+                    first[dest--] = std::move(first[cursor1--]);
+                    if (--len1 == 0) return;
+                    --minGallop;
+                } while (count1 >= TIM_MIN_GALLOP || count2 >= TIM_MIN_GALLOP);
+
+                if (minGallop < 0) minGallop = 0;
+                minGallop += 2;
             }
-            arr[j + 1] = key;
+        }();
+        if (minGallop < 1) minGallop = 1;
+
+        if (len2 == 1) {
+            dest -= len1;
+            cursor1 -= len1;
+            move_backward(first + cursor1 + 1, first + cursor1 + 1 + len1, first + dest + 1 + len1);
+            first[dest] = std::move(tmp[cursor2]);
+        } else {
+            move(tmp.begin(), tmp.begin() + len2, first + (dest - (len2 - 1)));
         }
     };
 
-    // Merge two sorted runs 
-    auto merge = [&](int l, int m, int r) {
-        vector<pair<int, int>> left(arr.begin() + l, arr.begin() + m + 1);
-        vector<pair<int, int>> right(arr.begin() + m + 1, arr.begin() + r + 1);
+    // Merges stack runs i and i+1
+    auto mergeAt = [&](int i) {
+        ptrdiff_t base1 = runs[i].base, len1 = runs[i].len;
+        ptrdiff_t base2 = runs[i + 1].base, len2 = runs[i + 1].len;
+
+        runs[i].len = len1 + len2;
+        if (i == stackSize - 3) runs[i + 1] = runs[i + 2];
+        --stackSize;
 
-        int i = 0, j = 0, k = l;
+        // Elements of run1 already <= run2's first element stay in place
+        ptrdiff_t k = timGallopRight(first[base2], first + base1, len1, 0, lt);
+        base1 += k;
+        len1 -= k;
+        if (len1 == 0) return;
 
-        while (i < left.size() && j < right.size()) {
-            if (left[i].first < right[j].first ||
-               (left[i].first == right[j].first && left[i].second <= right[j].second)) {
-                arr[k++] = left[i++];
+        // Elements of run2 already >= run1's last element stay in place
+        len2 = timGallopLeft(first[base1 + len1 - 1], first + base2, len2, len2 - 1, lt);
+        if (len2 == 0) return;
+
+        // Finely interleaved (int, int) records by key go through the vector merge kernel instead, with the
+        // smaller run in tmp as well: forwards from the front, or backwards from the back
+        if (simdMergeTakes(first + base1, len1, first + base2, len2, lt)) {
+            if (len1 <= len2) {
+                move(first + base1, first + base1 + len1, tmp.begin());
+                simdMergeRecords(tmp.begin(), len1, first + base2, len2, first + base1, lt);
             } else {
-                arr[k++] = right[j++];
+                move(first + base2, first + base2 + len2, tmp.begin());
+                simdMergeRecords(first + base1, len1, tmp.begin(), len2, first + base1, lt, true);
             }
+        } else if (len1 <= len2) {
+            mergeLo(base1, len1, base2, len2);
+        } else {
+            mergeHi(base1, len1, base2, len2);
         }
+    };
 
-        while (i < left.size()) arr[k++] = left[i++];
-        while (j < right.size()) arr[k++] = right[j++];
+    // Restores the stack invariants len[i-2] > len[i-1] + len[i] and len[i-1] > len[i]
+    auto mergeCollapse = [&] {
+        while (stackSize > 1) {
+            int i = stackSize - 2;
+            if ((i > 0 && runs[i - 1].len <= runs[i].len + runs[i + 1].len) ||
+                (i > 1 && runs[i - 2].len <= runs[i - 1].len + runs[i].len)) {
+                if (runs[i - 1].len < runs[i + 1].len) --i;
+            } else if (runs[i].len > runs[i + 1].len) {
+                break;
+            }
+            mergeAt(i);
+        }
     };
 
-    // Sort small runs using insertion sort
-    for (int i = 0; i < n; i += RUN) {
-        insertionSort(i, min(i + RUN - 1, n - 1));
-    }
+    // Scan natural runs, extending short ones to minrun with insertion sort (or a sorting network)
+    ptrdiff_t minRun = timMinRunLength(n);
+    ptrdiff_t lo = 0;
+    while (lo < n) {
+        ptrdiff_t runLen = timCountRunAndMakeAscending(first, lo, n, lt);
+        if (runLen < minRun) {
+            ptrdiff_t force = min(n - lo, minRun);
+            if (!simdSortLeaf(first + lo, first + lo + force, lt)) timInsertionSort(first, lo, lo + force, lo + runLen, lt);
+            runLen = force;
+        }
 
-    // Merge runs in increasing size: RUN, 2*RUN, 4*RUN, ...
-    for (int size = RUN; size < n; size *= 2) {
-        for (int left = 0; left < n; left += 2 * size) {
-            int mid = min(left + size - 1, n - 1);
-            int right = min(left + 2 * size - 1, n - 1);
+        runs[stackSize++] = {lo, runLen};
+        mergeCollapse();
+        lo += runLen;
+    }
 
-            if (mid < right)
-                merge(left, mid, right);
-        }
+    // Merge everything left on the stack
+    while (stackSize > 1) {
+        int i = stackSize - 2;
+        if (i > 0 && runs[i - 1].len < runs[i + 1].len) --i;
+        mergeAt(i);
     }
 }
 
+inline void TimSort(vector<pair<int, int>>& arr) {
+    TimSort(arr.begin(), arr.end());
+}
+REGISTER_RANGE_SORT(TimSort, "Tim Sort", 0.5, TimSort);
+
 // ------------------------------
 // Cocktail Shaker Sort (Stable)
 // ------------------------------
@@ -192,6 +521,7 @@ inline void CocktailShakerSort(vector<pair<int, int>>& arr) {
         ++start;
     }
 }
+REGISTER_QUADRATIC_SORT(CocktailShakerSort, "Cocktail Shaker Sort", CocktailShakerSort);
 
 // ------------------------------
 // Comb Sort (Not Stable)
@@ -213,110 +543,483 @@ inline void CombSort(vector<pair<int, int>>& arr) {
         }
     }
 }
+REGISTER_QUADRATIC_SORT(CombSort, "Comb Sort", CombSort);
+
+// ------------------------------
+// Loser Tree
+// ------------------------------
+// Tournament tree over k leaves in one flat array. Each internal node keeps the loser of its match
+// as (key, leaf index), so replaying a leaf touches only its root path and never the records.
+// Ties go to the lower leaf index, which makes merges and sorts built on it stable.
+template <typename K, typename Compare = less<>>
+class LoserTree {
+public:
+    LoserTree(size_t leaves, Compare comp = {}) : k(leaves), comp(comp), losers(leaves) {}
+
+    // Builds the tree bottom-up; keyOf(i) gives leaf i's initial key, live(i) whether it has one
+    template <typename KeyOf, typename Live>
+    void build(KeyOf keyOf, Live live) {
+        if (k == 0) return;
+        vector<Node> winners(2 * k);
+        for (size_t i = 0; i < k; ++i)
+            winners[k + i] = live(i) ? Node{keyOf(i), uint32_t(i)} : Node{K(), uint32_t(i) | EXHAUSTED};
+
+        for (size_t node = k - 1; node >= 1; --node) {
+            const Node& a = winners[2 * node];
+            const Node& b = winners[2 * node + 1];
+            if (beats(a, b)) {
+                winners[node] = a;
+                losers[node] = b;
+            } else {
+                winners[node] = b;
+                losers[node] = a;
+            }
+        }
+        champion = winners[1];
+    }
+
+    bool empty() const { return k == 0 || (champion.tag & EXHAUSTED); }
+    size_t winner() const { return champion.tag & ~EXHAUSTED; }
+
+    // The winning leaf has a new key: rerun only the matches on its path to the root
+    void replay(const K& key) { replayNode(Node{key, uint32_t(winner())}); }
+
+    // The winning leaf has run dry
+    void exhaust() { replayNode(Node{K(), uint32_t(winner()) | EXHAUSTED}); }
+
+private:
+    static constexpr uint32_t EXHAUSTED = 1u << 31;
+
+    struct Node {
+        K key;
+        uint32_t tag; // Leaf index, with EXHAUSTED set once the leaf has no more keys
+    };
+
+    // Non-short-circuit operators keep this branch-free for cheap keys
+    bool beats(const Node& a, const Node& b) const {
+        bool byTag = a.tag < b.tag;
+        if ((a.tag | b.tag) & EXHAUSTED) return byTag;
+        return comp(a.key, b.key) | (!comp(b.key, a.key) & byTag);
+    }
+
+    void replayNode(Node cur) {
+        // Written as selects: on random input every match is a coin flip for the branch predictor
+        for (size_t node = (winner() + k) / 2; node >= 1; node /= 2) {
+            Node stored = losers[node];
+            bool storedWins = beats(stored, cur);
+            losers[node] = storedWins ? cur : stored;
+            cur = storedWins ? stored : cur;
+        }
+        champion = cur;
+    }
+
+    size_t k;
+    Compare comp;
+    vector<Node> losers; // losers[1..k-1]; slot 0 unused
+    Node champion{};
+};
+
+// Stable k-way merge of sorted runs [runs[i].first, runs[i].second) into out; equal keys keep run order
+template <typename RunIt, typename OutIt, typename KeyFn = FirstKey, typename Compare = less<>>
+OutIt kWayMerge(const vector<pair<RunIt, RunIt>>& runs, OutIt out, KeyFn key = {}, Compare comp = {}) {
+    using K = decay_t<decltype(key(*runs[0].first))>;
+    vector<RunIt> cursor;
+    cursor.reserve(runs.size());
+    for (const auto& r : runs) cursor.push_back(r.first);
+
+    LoserTree<K, Compare> tree(runs.size(), comp);
+    tree.build([&](size_t i) { return key(*cursor[i]); },
+               [&](size_t i) { return cursor[i] != runs[i].second; });
+
+    while (!tree.empty()) {
+        size_t w = tree.winner();
+        *out++ = std::move(*cursor[w]);
+        if (++cursor[w] != runs[w].second) tree.replay(key(*cursor[w]));
+        else tree.exhaust();
+    }
+    return out;
+}
 
 // ------------------------------
 // Tournament Sort (Stable)
 // ------------------------------
-inline void TournamentSort(vector<pair<int, int>>& arr) {
-    int n = arr.size();
-    if (n == 0) return;
+const ptrdiff_t TOURNAMENT_LEAF_RUN = 64; // Elements per leaf, presorted by insertion sort
+
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void TournamentSort(RandomIt first, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    ptrdiff_t n = last - first;
+    if (n < 2) return;
+    auto lt = makeKeyLess(key, comp);
 
-    int m = 1;
-    while (m < n) m *= 2; // Expand to next power of 2
+    // Each leaf enters the tournament with a short sorted run instead of a single element:
+    // the tree shrinks by TOURNAMENT_LEAF_RUN and stays cache resident, and the root path gets shorter
+    vector<T> src(make_move_iterator(first), make_move_iterator(last));
+    vector<pair<typename vector<T>::iterator, typename vector<T>::iterator>> runs;
+    for (ptrdiff_t lo = 0; lo < n; lo += TOURNAMENT_LEAF_RUN) {
+        auto runBegin = src.begin() + lo, runEnd = src.begin() + min(lo + TOURNAMENT_LEAF_RUN, n);
+        timInsertionSort(runBegin, 0, runEnd - runBegin, 1, lt);
+        runs.emplace_back(runBegin, runEnd);
+    }
+
+    kWayMerge(runs, first, key, comp);
+}
 
-    vector<pair<int, int>> tree(2 * m, {INT_MAX, INT_MAX});
-    vector<bool> used(n, true); // Track unused elements
+inline void TournamentSort(vector<pair<int, int>>& arr) {
+    TournamentSort(arr.begin(), arr.end());
+}
+REGISTER_RANGE_SORT(TournamentSort, "Tournament Sort", 1.25, TournamentSort);
+
+// ------------------------------
+// Introsort (Unstable, pattern-defeating quicksort)
+// ------------------------------
+const ptrdiff_t PDQ_INSERTION_SORT_THRESHOLD = 24;  // Ranges below this are insertion sorted
+const ptrdiff_t PDQ_NINTHER_THRESHOLD = 128;        // Ranges above this use Tukey's ninther for the pivot
+const size_t PDQ_PARTIAL_INSERTION_SORT_LIMIT = 8;  // Moves allowed before a partial insertion sort gives up
+const size_t PDQ_BLOCK_SIZE = 64;                   // Elements classified per block in branchless partitioning
 
-    // Fill leaves
-    for (int i = 0; i < n; ++i)
-        tree[m + i] = arr[i];
+// Insertion sort on [begin, end)
+template <typename RandomIt, typename Less>
+void pdqInsertionSort(RandomIt begin, RandomIt end, Less lt) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    if (begin == end) return;
 
-    // Build internal nodes
-    for (int i = m - 1; i > 0; --i) {
-        auto l = tree[2 * i];
-        auto r = tree[2 * i + 1];
-        tree[i] = (l.first < r.first || (l.first == r.first && l.second <= r.second)) ? l : r;
+    for (RandomIt cur = begin + 1; cur != end; ++cur) {
+        RandomIt sift = cur;
+        RandomIt sift1 = cur - 1;
+        if (lt(*sift, *sift1)) {
+            T tmp = std::move(*sift);
+            do {
+                *sift-- = std::move(*sift1);
+            } while (sift != begin && lt(tmp, *--sift1));
+            *sift = std::move(tmp);
+        }
     }
+}
 
-    vector<pair<int, int>> result;
-    for (int k = 0; k < n; ++k) {
-        pair<int, int> winner = tree[1];
-        result.push_back(winner);
+// Insertion sort that relies on *(begin - 1) being <= every element, so the inner loop needs no bounds check
+template <typename RandomIt, typename Less>
+void pdqUnguardedInsertionSort(RandomIt begin, RandomIt end, Less lt) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    if (begin == end) return;
 
-        // Find index of winner in original array
-        int idx = -1;
-        for (int i = 0; i < n; ++i) {
-            if (used[i] && arr[i] == winner) {
-                idx = i;
-                break;
-            }
+    for (RandomIt cur = begin + 1; cur != end; ++cur) {
+        RandomIt sift = cur;
+        RandomIt sift1 = cur - 1;
+        if (lt(*sift, *sift1)) {
+            T tmp = std::move(*sift);
+            do {
+                *sift-- = std::move(*sift1);
+            } while (lt(tmp, *--sift1));
+            *sift = std::move(tmp);
         }
+    }
+}
 
-        used[idx] = false;
-        tree[m + idx] = {INT_MAX, INT_MAX};
+// Attempts an insertion sort, giving up after PDQ_PARTIAL_INSERTION_SORT_LIMIT moves.
+// Returns true if the range ended up sorted.
+template <typename RandomIt, typename Less>
+bool pdqPartialInsertionSort(RandomIt begin, RandomIt end, Less lt) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    if (begin == end) return true;
 
-        // Update tree
-        for (int i = (m + idx) / 2; i > 0; i /= 2) {
-            auto l = tree[2 * i];
-            auto r = tree[2 * i + 1];
-            tree[i] = (l.first < r.first || (l.first == r.first && l.second <= r.second)) ? l : r;
+    size_t limit = 0;
+    for (RandomIt cur = begin + 1; cur != end; ++cur) {
+        RandomIt sift = cur;
+        RandomIt sift1 = cur - 1;
+        if (lt(*sift, *sift1)) {
+            T tmp = std::move(*sift);
+            do {
+                *sift-- = std::move(*sift1);
+            } while (sift != begin && lt(tmp, *--sift1));
+            *sift = std::move(tmp);
+            limit += cur - sift;
         }
+        if (limit > PDQ_PARTIAL_INSERTION_SORT_LIMIT) return false;
     }
+    return true;
+}
 
-    arr = result;
+template <typename RandomIt, typename Less>
+inline void pdqSort2(RandomIt a, RandomIt b, Less lt) {
+    if (lt(*b, *a)) iter_swap(a, b);
 }
 
-// ------------------------------
-// Introsort (Unstable)
-// ------------------------------
-inline void IntroSort(vector<pair<int, int>>& arr) {
-    int depthLimit = 2 * log(arr.size());
-    function<void(int, int, int)> introsortUtil;
-    function<void(int, int)> heapSortIntro;
-    function<int(int, int)> partition;
-
-    // QuickSort partition
-    partition = [&](int low, int high) {
-        auto pivot = arr[high];
-        int i = low - 1;
-        for (int j = low; j < high; ++j)
-            if (arr[j].first <= pivot.first)
-                swap(arr[++i], arr[j]);
-        swap(arr[i + 1], arr[high]);
-        return i + 1;
-    };
+// Sorts the three elements so that *a <= *b <= *c
+template <typename RandomIt, typename Less>
+inline void pdqSort3(RandomIt a, RandomIt b, RandomIt c, Less lt) {
+    pdqSort2(a, b, lt);
+    pdqSort2(b, c, lt);
+    pdqSort2(a, b, lt);
+}
 
-    // HeapSort
-    heapSortIntro = [&](int begin, int end) {
-        function<void(int, int)> heapify = [&](int n, int i) {
-            int largest = i, l = 2 * i + 1, r = 2 * i + 2;
-            if (l < n && arr[begin + l].first > arr[begin + largest].first) largest = l;
-            if (r < n && arr[begin + r].first > arr[begin + largest].first) largest = r;
-            if (largest != i) {
-                swap(arr[begin + i], arr[begin + largest]);
-                heapify(n, largest);
+// Swaps the elements at the recorded offsets pairwise: first + offsetsL[i] <-> last - offsetsR[i].
+// When the counts differ a cyclic permutation is used instead, which needs fewer moves.
+template <typename RandomIt>
+void pdqSwapOffsets(RandomIt first, RandomIt last, unsigned char* offsetsL, unsigned char* offsetsR,
+                    size_t num, bool useSwaps) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    if (useSwaps) {
+        for (size_t i = 0; i < num; ++i)
+            iter_swap(first + offsetsL[i], last - offsetsR[i]);
+    } else if (num > 0) {
+        RandomIt l = first + offsetsL[0];
+        RandomIt r = last - offsetsR[0];
+        T tmp(std::move(*l));
+        *l = std::move(*r);
+        for (size_t i = 1; i < num; ++i) {
+            l = first + offsetsL[i];
+            *r = std::move(*l);
+            r = last - offsetsR[i];
+            *l = std::move(*r);
+        }
+        *r = std::move(tmp);
+    }
+}
+
+// Partitions [begin, end) around the pivot *begin: elements < pivot go left, >= pivot go right.
+// Elements are classified a block at a time into offset buffers without branching on the comparison
+// (BlockQuicksort), then swapped in bulk. Returns the pivot position and whether no swaps were needed.
+template <typename RandomIt, typename Less>
+pair<RandomIt, bool> pdqPartitionRightBranchless(RandomIt begin, RandomIt end, Less lt) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    T pivot(std::move(*begin));
+    RandomIt first = begin;
+    RandomIt last = end;
+
+    // Find the first element >= pivot (the median-of-3 guarantees one exists)
+    while (lt(*++first, pivot));
+
+    // Find the last element < pivot; guard only if nothing was skipped on the left
+    if (first - 1 == begin) while (first < last && !lt(*--last, pivot));
+    else                    while (!lt(*--last, pivot));
+
+    bool alreadyPartitioned = first >= last;
+    if (!alreadyPartitioned) {
+        iter_swap(first, last);
+        ++first;
+
+        alignas(64) unsigned char offsetsL[PDQ_BLOCK_SIZE];
+        alignas(64) unsigned char offsetsR[PDQ_BLOCK_SIZE];
+        unsigned char* offL = offsetsL;
+        unsigned char* offR = offsetsR;
+        RandomIt offsetsLBase = first;
+        RandomIt offsetsRBase = last;
+        size_t numL = 0, numR = 0, startL = 0, startR = 0;
+
+        while (first < last) {
+            // Fill whichever offset buffers are empty; split the remainder when both are
+            size_t numUnknown = last - first;
+            size_t leftSplit = numL == 0 ? (numR == 0 ? numUnknown / 2 : numUnknown) : 0;
+            size_t rightSplit = numR == 0 ? (numUnknown - leftSplit) : 0;
+
+            // Record offsets of misplaced elements (>= pivot) on the left
+            if (leftSplit >= PDQ_BLOCK_SIZE) leftSplit = PDQ_BLOCK_SIZE;
+            for (size_t i = 0; i < leftSplit; ++i) {
+                offL[numL] = static_cast<unsigned char>(i);
+                numL += !lt(*first, pivot);
+                ++first;
+            }
+
+            // Record offsets of misplaced elements (< pivot) on the right
+            if (rightSplit >= PDQ_BLOCK_SIZE) rightSplit = PDQ_BLOCK_SIZE;
+            for (size_t i = 0; i < rightSplit;) {
+                offR[numR] = static_cast<unsigned char>(++i);
+                numR += lt(*--last, pivot);
+            }
+
+            // Swap as many misplaced pairs as possible
+            size_t num = min(numL, numR);
+            pdqSwapOffsets(offsetsLBase, offsetsRBase, offL + startL, offR + startR, num, numL == numR);
+            numL -= num;
+            numR -= num;
+            startL += num;
+            startR += num;
+            if (numL == 0) {
+                startL = 0;
+                offsetsLBase = first;
+            }
+            if (numR == 0) {
+                startR = 0;
+                offsetsRBase = last;
             }
-        };
-        int n = end - begin + 1;
-        for (int i = n / 2 - 1; i >= 0; --i) heapify(n, i);
-        for (int i = n - 1; i > 0; --i) {
-            swap(arr[begin], arr[begin + i]);
-            heapify(i, 0);
         }
-    };
 
-    // Recursive Introsort
-    introsortUtil = [&](int begin, int end, int depthLimit) {
-        if (begin < end) {
-            if (depthLimit == 0) {
-                heapSortIntro(begin, end);
+        // At most one buffer still has misplaced elements; move them next to the boundary
+        if (numL) {
+            offL += startL;
+            while (numL--) iter_swap(offsetsLBase + offL[numL], --last);
+            first = last;
+        }
+        if (numR) {
+            offR += startR;
+            while (numR--) iter_swap(offsetsRBase - offR[numR], first), ++first;
+            last = first;
+        }
+    }
+
+    // Put the pivot in the right place
+    RandomIt pivotPos = first - 1;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return make_pair(pivotPos, alreadyPartitioned);
+}
+
+// Branchy Hoare-style version of pdqPartitionRightBranchless, for expensive comparisons
+template <typename RandomIt, typename Less>
+pair<RandomIt, bool> pdqPartitionRight(RandomIt begin, RandomIt end, Less lt) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    T pivot(std::move(*begin));
+    RandomIt first = begin;
+    RandomIt last = end;
+
+    while (lt(*++first, pivot));
+    if (first - 1 == begin) while (first < last && !lt(*--last, pivot));
+    else                    while (!lt(*--last, pivot));
+
+    bool alreadyPartitioned = first >= last;
+
+    // Swap misplaced pairs; the sentinels found above keep the scans in bounds
+    while (first < last) {
+        iter_swap(first, last);
+        while (lt(*++first, pivot));
+        while (!lt(*--last, pivot));
+    }
+
+    RandomIt pivotPos = first - 1;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return make_pair(pivotPos, alreadyPartitioned);
+}
+
+// Partitions [begin, end) so that elements equal to the pivot *begin go left with it.
+// Used when the pivot equals the element just before the range: the whole equal-key
+// block then ends up left of the returned position and is never visited again.
+template <typename RandomIt, typename Less>
+RandomIt pdqPartitionLeft(RandomIt begin, RandomIt end, Less lt) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    T pivot(std::move(*begin));
+    RandomIt first = begin;
+    RandomIt last = end;
+
+    while (lt(pivot, *--last));
+    if (last + 1 == end) while (first < last && !lt(pivot, *++first));
+    else                 while (!lt(pivot, *++first));
+
+    while (first < last) {
+        iter_swap(first, last);
+        while (lt(pivot, *--last));
+        while (!lt(pivot, *++first));
+    }
+
+    RandomIt pivotPos = last;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return pivotPos;
+}
+
+// Main pdqsort loop: recurses on the left part and iterates on the right.
+// badAllowed counts how many highly unbalanced partitions are tolerated before heap sort takes over.
+template <bool Branchless, typename RandomIt, typename Less>
+void pdqSortLoop(RandomIt begin, RandomIt end, Less lt, int badAllowed, bool leftmost = true) {
+    while (true) {
+        ptrdiff_t size = end - begin;
+
+        // Leaves one sorting network takes (up to SIMD_LEAF_MAX (int, int) records) skip the remaining
+        // partitions, as in QuickSort; other small ranges are insertion sorted
+        if (sortSmallRange(begin, end, lt)) return;
+        if (size < PDQ_INSERTION_SORT_THRESHOLD) {
+            if (leftmost) pdqInsertionSort(begin, end, lt);
+            else pdqUnguardedInsertionSort(begin, end, lt);
+            return;
+        }
+
+        // Pivot selection: median-of-3, or pseudomedian-of-9 for large ranges; the pivot ends up at *begin
+        ptrdiff_t s2 = size / 2;
+        if (size > PDQ_NINTHER_THRESHOLD) {
+            pdqSort3(begin, begin + s2, end - 1, lt);
+            pdqSort3(begin + 1, begin + (s2 - 1), end - 2, lt);
+            pdqSort3(begin + 2, begin + (s2 + 1), end - 3, lt);
+            pdqSort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), lt);
+            iter_swap(begin, begin + s2);
+        } else {
+            pdqSort3(begin + s2, begin, end - 1, lt);
+        }
+
+        // If the pivot equals the element before this range (a previous pivot), every element
+        // equal to it is already in place: peel them off in one partition_left pass
+        if (!leftmost && !lt(*(begin - 1), *begin)) {
+            begin = pdqPartitionLeft(begin, end, lt) + 1;
+            continue;
+        }
+
+        pair<RandomIt, bool> partResult =
+            Branchless ? pdqPartitionRightBranchless(begin, end, lt) : pdqPartitionRight(begin, end, lt);
+        RandomIt pivotPos = partResult.first;
+        bool alreadyPartitioned = partResult.second;
+
+        ptrdiff_t lSize = pivotPos - begin;
+        ptrdiff_t rSize = end - (pivotPos + 1);
+        bool highlyUnbalanced = lSize < size / 8 || rSize < size / 8;
+
+        if (highlyUnbalanced) {
+            // Too many bad partitions: fall back to heap sort for a guaranteed O(n log n)
+            if (--badAllowed == 0) {
+                heapSortRange(begin, end, lt);
                 return;
             }
-            int pi = partition(begin, end);
-            introsortUtil(begin, pi - 1, depthLimit - 1);
-            introsortUtil(pi + 1, end, depthLimit - 1);
+
+            // Otherwise shuffle a few elements to break up the pattern that caused it
+            if (lSize >= PDQ_INSERTION_SORT_THRESHOLD) {
+                iter_swap(begin, begin + lSize / 4);
+                iter_swap(pivotPos - 1, pivotPos - lSize / 4);
+                if (lSize > PDQ_NINTHER_THRESHOLD) {
+                    iter_swap(begin + 1, begin + (lSize / 4 + 1));
+                    iter_swap(begin + 2, begin + (lSize / 4 + 2));
+                    iter_swap(pivotPos - 2, pivotPos - (lSize / 4 + 1));
+                    iter_swap(pivotPos - 3, pivotPos - (lSize / 4 + 2));
+                }
+            }
+            if (rSize >= PDQ_INSERTION_SORT_THRESHOLD) {
+                iter_swap(pivotPos + 1, pivotPos + (1 + rSize / 4));
+                iter_swap(end - 1, end - rSize / 4);
+                if (rSize > PDQ_NINTHER_THRESHOLD) {
+                    iter_swap(pivotPos + 2, pivotPos + (2 + rSize / 4));
+                    iter_swap(pivotPos + 3, pivotPos + (3 + rSize / 4));
+                    iter_swap(end - 2, end - (1 + rSize / 4));
+                    iter_swap(end - 3, end - (2 + rSize / 4));
+                }
+            }
+        } else if (alreadyPartitioned &&
+                   pdqPartialInsertionSort(begin, pivotPos, lt) &&
+                   pdqPartialInsertionSort(pivotPos + 1, end, lt)) {
+            // The partition needed no swaps and both sides were (nearly) sorted: done
+            return;
         }
-    };
 
-    introsortUtil(0, arr.size() - 1, depthLimit);
+        // Recurse into the left part, loop on the right
+        pdqSortLoop<Branchless>(begin, pivotPos, lt, badAllowed, leftmost);
+        begin = pivotPos + 1;
+        leftmost = false;
+    }
+}
+
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void IntroSort(RandomIt first, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    ptrdiff_t n = last - first;
+    if (n < 2) return;
+
+    // Depth budget: floor(log2(n)) unbalanced partitions before the heap sort fallback
+    int depthLimit = 0;
+    while (n >>= 1) ++depthLimit;
+
+    // Block partitioning only pays off when a comparison is cheap enough to compute unconditionally
+    using KeyType = decay_t<decltype(key(*first))>;
+    constexpr bool branchless = is_arithmetic<KeyType>::value;
+    pdqSortLoop<branchless>(first, last, makeKeyLess(key, comp), depthLimit);
+}
+
+inline void IntroSort(vector<pair<int, int>>& arr) {
+    IntroSort(arr.begin(), arr.end());
 }
+REGISTER_RANGE_SORT(IntroSort, "Intro Sort", 0, IntroSort);
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+using namespace std;
+
+// ------------------------------
+// Allocation Counter
+// ------------------------------
+// Fed by the global operator new/delete that main.cpp replaces; stays 0 in programs that don't replace them
+inline atomic<size_t> allocationCounter{0};
+inline atomic<size_t> allocatedBytes{0}; // Total bytes handed out, never decreases
+inline atomic<size_t> liveBytes{0};      // Bytes currently allocated
+inline atomic<size_t> peakLiveBytes{0};  // High-water mark of liveBytes since the last tracker started
+
+inline size_t allocationCount() { return allocationCounter.load(memory_order_relaxed); }
+
+inline void recordAllocation(size_t bytes) {
+    allocationCounter.fetch_add(1, memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, memory_order_relaxed);
+    size_t live = liveBytes.fetch_add(bytes, memory_order_relaxed) + bytes;
+    size_t peak = peakLiveBytes.load(memory_order_relaxed);
+    while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {}
+}
+
+inline void recordDeallocation(size_t bytes) {
+    liveBytes.fetch_sub(bytes, memory_order_relaxed);
+}
+
+// Heap traffic of one measured region
+struct AllocationStats {
+    size_t allocations = 0;
+    size_t bytes = 0;     // Bytes allocated in total
+    size_t peakBytes = 0; // Most bytes live at once, above what was live when the region started
+};
+
+// Starts measuring on construction; stop() returns what happened since.
+// Regions must not nest: each tracker resets the shared high-water mark.
+class AllocationTracker {
+public:
+    AllocationTracker()
+        : startCount(allocationCounter.load(memory_order_relaxed)),
+          startBytes(allocatedBytes.load(memory_order_relaxed)),
+          startLive(liveBytes.load(memory_order_relaxed)) {
+        peakLiveBytes.store(startLive, memory_order_relaxed);
+    }
+
+    AllocationStats stop() const {
+        AllocationStats stats;
+        stats.allocations = allocationCounter.load(memory_order_relaxed) - startCount;
+        stats.bytes = allocatedBytes.load(memory_order_relaxed) - startBytes;
+        size_t peak = peakLiveBytes.load(memory_order_relaxed);
+        stats.peakBytes = peak > startLive ? peak - startLive : 0;
+        return stats;
+    }
+
+private:
+    size_t startCount, startBytes, startLive;
+};
@@ -3,79 +3,436 @@
 #include <algorithm>
 #include <climits>
 #include <cmath>
+#include <cstdint>
+#include <iterator>
+
+#include "simd_sort.h"
+#include "sort_registry.h"
+#include "sort_traits.h"
+#include "sorting_networks.h"
 
 using namespace std;
 
 // ------------------------------
 // Merge Sort (Stable)
 // ------------------------------
-inline void MergeSort(vector<pair<int, int>>& arr, int left, int right) {
-    if (left >= right) return;
-    int mid = (left + right) / 2;
+const ptrdiff_t MERGE_SORT_INSERTION_THRESHOLD = 16; // Subarrays up to this size are insertion sorted
 
-    // Recursively divide left and right halves
-    MergeSort(arr, left, mid);
-    MergeSort(arr, mid + 1, right);
+// Stable insertion sort of [first, last)
+template <typename RandomIt, typename Less>
+void insertionSortRange(RandomIt first, RandomIt last, Less lt) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    for (RandomIt i = first + (first != last); i < last; ++i) {
+        T cur = std::move(*i);
+        RandomIt j = i;
+
+        // Shift larger elements to the right
+        while (j != first && lt(cur, *(j - 1))) {
+            *j = std::move(*(j - 1));
+            --j;
+        }
+        *j = std::move(cur);
+    }
+}
 
-    vector<pair<int, int>> merged;
-    int i = left, j = mid + 1;
+// Leaf size for merge sorts: larger when a (stable, word-based) sorting network takes the leaves instead of insertion sort
+template <typename RandomIt, typename Less>
+ptrdiff_t mergeSortLeafSize() {
+    return simdLeafSupported<RandomIt, Less>() ? static_cast<ptrdiff_t>(simdLeafMax()) : MERGE_SORT_INSERTION_THRESHOLD;
+}
 
-    // Merge: pick the smaller element each time
-    while (i <= mid && j <= right) {
-        if (arr[i].first <= arr[j].first) {
-            merged.push_back(arr[i++]);
-        } else {
-            merged.push_back(arr[j++]);
+// Sorts a leaf with the SIMD network where it applies, else by insertion
+template <typename RandomIt, typename Less>
+void sortLeaf(RandomIt first, RandomIt last, Less lt) {
+    if (!simdSortLeaf(first, last, lt)) insertionSortRange(first, last, lt);
+}
+
+// Unstable small-range sort for the quicksorts: a compile-time network up to SORTING_NETWORK_MAX records,
+// then the SIMD leaf; false if the range is longer than both
+template <typename RandomIt, typename Less>
+bool sortSmallRange(RandomIt first, RandomIt last, Less lt) {
+    return networkSort(first, last, lt) || simdSortLeaf(first, last, lt);
+}
+
+// Co-ranking: how many of the first k merged outputs come from a[0, m) when merging with b[0, n).
+// Ties go to a, matching a stable merge. A caller that already knows the answer lies in [lo, hi]
+// (from a neighbouring co-rank) can pass those bounds and search only there.
+template <typename ItA, typename ItB, typename Less>
+ptrdiff_t coRank(ptrdiff_t k, ItA a, ptrdiff_t m, ItB b, ptrdiff_t n, Less lt,
+                 ptrdiff_t lo = 0, ptrdiff_t hi = PTRDIFF_MAX) {
+    lo = max(lo, max<ptrdiff_t>(0, k - n));
+    hi = min(hi, min(k, m));
+    while (lo < hi) {
+        ptrdiff_t i = lo + (hi - lo) / 2;
+        ptrdiff_t j = k - i;
+
+        // a[i] <= b[j-1] means a[i] must be emitted before b[j-1]: take more from a
+        if (i < m && j > 0 && !lt(b[j - 1], a[i])) lo = i + 1;
+        else hi = i;
+    }
+    return lo;
+}
+
+const ptrdiff_t SIMD_MERGE_CHUNK = 512; // Output records per packed chunk of simdMergeRecords
+
+// One chunk of a co-ranked merge, packed for the word kernel: its records copied out and, unless they are
+// already in order, their (key, position) words from each input. Positions number a's records before b's,
+// so equal keys keep a first.
+struct PackedMergeChunk {
+    ptrdiff_t k0 = 0, size = 0, lenA = 0, lenB = 0;
+    bool ordered = false; // The chunk's part of a preceded its part of b and went straight to out
+    int64_t wordsA[SIMD_MERGE_CHUNK], wordsB[SIMD_MERGE_CHUNK], merged[SIMD_MERGE_CHUNK];
+    pair<int, int> records[SIMD_MERGE_CHUNK];
+
+    // Takes the outputs [start, end), which merge a[i0, i1) with b from start - i0. A chunk whose parts
+    // are already in order (runs of equal or clustered keys) is moved to out here instead of packed:
+    // no later chunk reads what it overwrites, in either direction.
+    template <typename ItA, typename ItB, typename OutIt, typename Less>
+    void pack(ItA a, ItB b, OutIt out, ptrdiff_t start, ptrdiff_t end, ptrdiff_t i0, ptrdiff_t i1, Less lt,
+              bool backwards) {
+        k0 = start;
+        size = end - start;
+        lenA = i1 - i0;
+        lenB = size - lenA;
+        ItB b0 = b + (start - i0);
+        ordered = lenA == 0 || lenB == 0 || !lt(b0[0], a[i1 - 1]);
+        if (ordered) {
+            // Forwards out trails both inputs; backwards it leads a, so a's part moves last and from its end
+            if (backwards) {
+                move(b0, b0 + lenB, out + start + lenA);
+                move_backward(a + i0, a + i1, out + start + lenA);
+            } else {
+                move(a + i0, a + i1, out + start);
+                move(b0, b0 + lenB, out + start + lenA);
+            }
+            return;
+        }
+        copy(a + i0, a + i1, records);
+        copy(b0, b0 + lenB, records + lenA);
+        for (ptrdiff_t i = 0; i < lenA; ++i) wordsA[i] = simdLeafWord(records[i].first, static_cast<uint32_t>(i));
+        for (ptrdiff_t j = 0; j < lenB; ++j)
+            wordsB[j] = simdLeafWord(records[lenA + j].first, static_cast<uint32_t>(lenA + j));
+    }
+
+    void merge() { mergeWords(wordsA, lenA, wordsB, lenB, merged); }
+
+    template <typename OutIt>
+    void unpack(OutIt out) const {
+        if (ordered) return;
+        for (ptrdiff_t k = 0; k < size; ++k) out[k0 + k] = records[static_cast<uint32_t>(merged[k])];
+    }
+};
+
+// True if a[0, na) and b[0, nb) interleave finely: a scalar merge of their head would switch inputs at
+// least once per SIMD_MERGE_STREAK outputs. The scalar merge predicts long streaks (few unique keys,
+// presorted runs) well enough to beat the vector kernel there; only read, nothing is written.
+const ptrdiff_t SIMD_MERGE_STREAK = 4;
+
+template <typename ItA, typename ItB, typename Less>
+bool mergeInterleaves(ItA a, ptrdiff_t na, ItB b, ptrdiff_t nb, Less lt) {
+    ptrdiff_t i = 0, j = 0, switches = 0;
+    bool fromA = true;
+    while (i < na && j < nb && i + j < SIMD_MERGE_CHUNK) {
+        bool takeA = !lt(b[j], a[i]);
+        switches += takeA != fromA;
+        fromA = takeA;
+        takeA ? ++i : ++j;
+    }
+    return switches * SIMD_MERGE_STREAK >= i + j;
+}
+
+// True if simdMergeRecords should take this merge: the records, ordering and SIMD level allow it and the
+// inputs interleave finely
+template <typename ItA, typename ItB, typename Less>
+bool simdMergeTakes(ItA a, ptrdiff_t na, ItB b, ptrdiff_t nb, Less lt) {
+    return simdLeafSupported<ItA, Less>() && simdLeafSupported<ItB, Less>() && simdLevel() != SimdLevel::Scalar &&
+           simdMergeSetting() && mergeInterleaves(a, na, b, nb, lt);
+}
+
+// Stable merge of a[0, na) and b[0, nb) into out through the vector merge kernel, two chunks per kernel
+// call where both need merging. No chunk writes its output before its inputs are read, so out
+// may overlap the inputs the way an in-place merge does: ahead of b when merging forwards, after a when
+// backwards. Callers check simdMergeTakes first.
+template <typename ItA, typename ItB, typename OutIt, typename Less>
+void simdMergeRecords(ItA a, ptrdiff_t na, ItB b, ptrdiff_t nb, OutIt out, Less lt, bool backwards = false) {
+    if constexpr (simdLeafSupported<ItA, Less>() && simdLeafSupported<ItB, Less>()) {
+        ptrdiff_t n = na + nb, chunks = (n + SIMD_MERGE_CHUNK - 1) / SIMD_MERGE_CHUNK;
+
+        // Chunks go in order, so each co-rank is searched within one chunk's length of the previous one
+        ptrdiff_t edge = backwards ? na : 0; // Co-rank of the chunk boundary reached so far
+        auto packNext = [&](PackedMergeChunk& chunk, ptrdiff_t c) {
+            ptrdiff_t start = (backwards ? chunks - 1 - c : c) * SIMD_MERGE_CHUNK, end = min(n, start + SIMD_MERGE_CHUNK);
+            if (backwards) {
+                ptrdiff_t i0 = coRank(start, a, na, b, nb, lt, edge - (end - start), edge);
+                chunk.pack(a, b, out, start, end, i0, edge, lt, true);
+                edge = i0;
+            } else {
+                ptrdiff_t i1 = coRank(end, a, na, b, nb, lt, edge, edge + (end - start));
+                chunk.pack(a, b, out, start, end, edge, i1, lt, false);
+                edge = i1;
+            }
+        };
+        PackedMergeChunk x, y;
+        for (ptrdiff_t c = 0; c < chunks; c += 2) {
+            packNext(x, c);
+            bool second = c + 1 < chunks;
+            if (second) packNext(y, c + 1);
+
+            if (second && !x.ordered && !y.ordered) {
+                mergeWordsPair(x.wordsA, x.lenA, x.wordsB, x.lenB, x.merged,
+                               y.wordsA, y.lenA, y.wordsB, y.lenB, y.merged);
+            } else {
+                if (!x.ordered) x.merge();
+                if (second && !y.ordered) y.merge();
+            }
+            x.unpack(out);
+            if (second) y.unpack(out);
         }
     }
+}
+
+// Stable merge of the sorted runs src[0, mid) and src[mid, n) into dst
+template <typename SrcIt, typename DstIt, typename Less>
+void mergeRunsInto(SrcIt src, ptrdiff_t mid, ptrdiff_t n, DstIt dst, Less lt) {
+    // Runs already in order (or no right run): nothing to merge
+    if (mid == n || !lt(src[mid], src[mid - 1])) {
+        move(src, src + n, dst);
+        return;
+    }
+    if (simdMergeTakes(src, mid, src + mid, n - mid, lt)) {
+        simdMergeRecords(src, mid, src + mid, n - mid, dst, lt);
+        return;
+    }
+
+    // Merge: pick the smaller element each time (left wins ties for stability)
+    ptrdiff_t i = 0, j = mid;
+    while (i < mid && j < n) {
+        if (!lt(src[j], src[i])) *dst++ = std::move(src[i++]);
+        else *dst++ = std::move(src[j++]);
+    }
 
     // Merge remaining elements
-    while (i <= mid) merged.push_back(arr[i++]);
-    while (j <= right) merged.push_back(arr[j++]);
+    dst = move(src + i, src + mid, dst);
+    move(src + j, src + n, dst);
+}
 
-    // Copy back to original array
-    for (int k = 0; k < merged.size(); ++k) {
-        arr[left + k] = merged[k];
+// Sorts arr[0, n) with buf[0, n) as scratch; the result lands in buf if resultInBuf, else back in arr.
+// Halves are sorted into the opposite array, so each level merges straight into its destination.
+template <typename RandomIt, typename BufIt, typename Less>
+void mergeSortInto(RandomIt arr, BufIt buf, ptrdiff_t n, bool resultInBuf, Less lt, ptrdiff_t leaf) {
+    if (n <= leaf) {
+        sortLeaf(arr, arr + n, lt);
+        if (resultInBuf) move(arr, arr + n, buf);
+        return;
     }
+
+    // Recursively divide left and right halves
+    ptrdiff_t mid = n / 2;
+    mergeSortInto(arr, buf, mid, !resultInBuf, lt, leaf);
+    mergeSortInto(arr + mid, buf + mid, n - mid, !resultInBuf, lt, leaf);
+
+    if (resultInBuf) mergeRunsInto(arr, mid, n, buf, lt);
+    else mergeRunsInto(buf, mid, n, arr, lt);
+}
+
+// Top-down merge sort; allocates one n-element buffer per call and nothing else
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void MergeSort(RandomIt first, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    ptrdiff_t n = last - first;
+    auto lt = makeKeyLess(key, comp);
+    ptrdiff_t leaf = mergeSortLeafSize<RandomIt, decltype(lt)>();
+    if (n <= leaf) {
+        sortLeaf(first, last, lt);
+        return;
+    }
+
+    vector<T> buf(n);
+    mergeSortInto(first, buf.begin(), n, false, lt, leaf);
 }
 
+inline void MergeSort(vector<pair<int, int>>& arr, int left, int right) {
+    if (left >= right) return;
+    MergeSort(arr.begin() + left, arr.begin() + right + 1);
+}
+REGISTER_RANGE_SORT(MergeSort, "Merge Sort", 1, MergeSort);
+
+// Bottom-up merge sort: leaf runs sorted by network or insertion, then passes of doubling width that alternate
+// between the input and one buffer. No recursion.
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void MergeSortBottomUp(RandomIt first, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    ptrdiff_t n = last - first;
+    auto lt = makeKeyLess(key, comp);
+
+    ptrdiff_t leaf = mergeSortLeafSize<RandomIt, decltype(lt)>();
+    for (ptrdiff_t lo = 0; lo < n; lo += leaf) sortLeaf(first + lo, first + min(lo + leaf, n), lt);
+    if (n <= leaf) return;
+
+    vector<T> buf(n);
+    bool inBuf = false;
+    for (ptrdiff_t width = leaf; width < n; width *= 2) {
+        for (ptrdiff_t lo = 0; lo < n; lo += 2 * width) {
+            ptrdiff_t mid = min(width, n - lo), len = min(2 * width, n - lo);
+            if (inBuf) mergeRunsInto(buf.begin() + lo, mid, len, first + lo, lt);
+            else mergeRunsInto(first + lo, mid, len, buf.begin() + lo, lt);
+        }
+        inBuf = !inBuf;
+    }
+
+    if (inBuf) move(buf.begin(), buf.end(), first);
+}
+
+inline void MergeSortBottomUp(vector<pair<int, int>>& arr) {
+    MergeSortBottomUp(arr.begin(), arr.end());
+}
+REGISTER_RANGE_SORT(MergeSortBottomUp, "Bottom-Up Merge Sort", 1, MergeSortBottomUp);
+
 // ------------------------------
 // Heap Sort (Unstable)
 // ------------------------------
-inline void Heapify(vector<pair<int, int>>& arr, int n, int i) {
-    int largest = i;
-    int l = 2 * i + 1;
-    int r = 2 * i + 2;
+// Implicit d-ary max-heap: the children of i are D*i+1 .. D*i+D. Wider nodes halve (4-ary) or third (8-ary)
+// the depth, and a node's children sit next to each other, so a level costs one or two cache lines instead
+// of a cache line per comparison. Sifts use Floyd's bottom-up scheme: the hole left by the moved record runs
+// down to a leaf along the largest children (D-1 comparisons per level, no test against the record), then
+// the record climbs back up the few levels it needs. Records move, never swap.
+const size_t HEAP_CACHE_LINE = 64; // Bytes of children a node aims to fill
+
+inline size_t& heapAritySetting() {
+    static size_t arity = 0; // 0 = by record size
+    return arity;
+}
 
-    // Compare with left child
-    if (l < n && arr[l].first > arr[largest].first)
-        largest = l;
+// Children per node for the heaps heapSortRange builds: 2, 4 or 8, or 0 to fit a cache line
+inline void setHeapArity(size_t arity) {
+    heapAritySetting() = arity == 2 || arity == 4 || arity == 8 ? arity : 0;
+}
 
-    // Compare with right child
-    if (r < n && arr[r].first > arr[largest].first)
-        largest = r;
+// Arity for records of recordBytes bytes: the setting, or as many children (2 to 8) as fill a cache line
+inline size_t heapArity(size_t recordBytes) {
+    if (heapAritySetting()) return heapAritySetting();
+    return recordBytes * 8 <= HEAP_CACHE_LINE ? 8 : recordBytes * 4 <= HEAP_CACHE_LINE ? 4 : 2;
+}
 
-    // Swap with larger child and heapify again
-    if (largest != i) {
-        swap(arr[i], arr[largest]);
-        Heapify(arr, n, largest);
+// Index of the largest of the children [child, min(child + D, n)). A full set of children is reduced as a
+// tournament of masked selects: the comparisons of a round don't wait on each other, and nothing branches
+// on the data.
+template <size_t D, typename RandomIt, typename Less>
+inline ptrdiff_t heapLargestChild(RandomIt first, ptrdiff_t child, ptrdiff_t n, Less lt) {
+    if (child + static_cast<ptrdiff_t>(D) > n) {
+        ptrdiff_t best = child;
+        for (ptrdiff_t c = child + 1; c < n; ++c) best = lt(first[best], first[c]) ? c : best;
+        return best;
+    }
+    ptrdiff_t idx[D];
+#pragma GCC unroll 8
+    for (size_t c = 0; c < D; ++c) idx[c] = child + c;
+#pragma GCC unroll 4
+    for (size_t width = D / 2; width >= 1; width /= 2) {
+#pragma GCC unroll 4
+        for (size_t c = 0; c < width; ++c) {
+            ptrdiff_t a = idx[2 * c], b = idx[2 * c + 1];
+            idx[c] = a ^ ((a ^ b) & -static_cast<ptrdiff_t>(lt(first[a], first[b])));
+        }
     }
+    return idx[0];
 }
 
-inline void HeapSort(vector<pair<int, int>>& arr) {
-    int n = arr.size();
+// Prefetches the grandchildren of the node whose first child is child: by the time the hole gets there,
+// the D*D records (a few cache lines) are on their way
+template <size_t D, typename RandomIt>
+inline void heapPrefetchGrandchildren(RandomIt first, ptrdiff_t child, ptrdiff_t n) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    ptrdiff_t grandchild = static_cast<ptrdiff_t>(D) * child + 1;
+    if (grandchild >= n) return;
+    const char* p = reinterpret_cast<const char*>(&*(first + grandchild));
+    size_t bytes = min<size_t>(D * D, n - grandchild) * sizeof(T);
+    for (size_t offset = 0; offset < bytes; offset += HEAP_CACHE_LINE) __builtin_prefetch(p + offset);
+}
 
-    // Build max heap
-    for (int i = n / 2 - 1; i >= 0; --i)
-        Heapify(arr, n, i);
+// Places value into the hole at index hole, moving parents down while they are smaller, but no higher than top
+template <size_t D, typename RandomIt, typename T, typename Less>
+void heapSiftUp(RandomIt first, ptrdiff_t top, ptrdiff_t hole, T value, Less lt) {
+    while (hole > top) {
+        ptrdiff_t parent = (hole - 1) / D;
+        if (!lt(first[parent], value)) break;
+        first[hole] = std::move(first[parent]);
+        hole = parent;
+    }
+    first[hole] = std::move(value);
+}
 
-    // Extract root and place at end
-    for (int i = n - 1; i > 0; --i) {
-        swap(arr[0], arr[i]);
-        Heapify(arr, i, 0);
+// Places value into the hole at index hole of a heap of n records whose subtrees below the hole are heaps
+template <size_t D, typename RandomIt, typename T, typename Less>
+void heapSiftDown(RandomIt first, ptrdiff_t n, ptrdiff_t hole, T value, Less lt) {
+    ptrdiff_t top = hole;
+
+    // Walk the hole down to a leaf along the largest children
+    for (ptrdiff_t child = D * hole + 1; child < n; child = D * hole + 1) {
+        heapPrefetchGrandchildren<D>(first, child, n);
+        ptrdiff_t best = heapLargestChild<D>(first, child, n, lt);
+        first[hole] = std::move(first[best]);
+        hole = best;
     }
+
+    // Climb back up to where value belongs; after an extraction that is usually at or near the leaf
+    heapSiftUp<D>(first, top, hole, std::move(value), lt);
+}
+
+// Restores the binary heap property at i, for [first, first + n) whose subtrees below i are heaps
+template <typename RandomIt, typename Less>
+void Heapify(RandomIt first, ptrdiff_t n, ptrdiff_t i, Less lt) {
+    heapSiftDown<2>(first, n, i, std::move(first[i]), lt);
 }
 
+inline void Heapify(vector<pair<int, int>>& arr, int n, int i) {
+    Heapify(arr.begin(), n, i, makeKeyLess(FirstKey{}, less<>{}));
+}
+
+// Builds a D-ary max-heap over [first, first + n), last parent first
+template <size_t D, typename RandomIt, typename Less>
+void makeHeap(RandomIt first, ptrdiff_t n, Less lt) {
+    for (ptrdiff_t i = (n - 2) / static_cast<ptrdiff_t>(D); n > 1 && i >= 0; --i)
+        heapSiftDown<D>(first, n, i, std::move(first[i]), lt);
+}
+
+// Sorts a D-ary max-heap of n records in place: the root moves to the end, and the displaced last record
+// is sifted down from the root
+template <size_t D, typename RandomIt, typename Less>
+void sortHeap(RandomIt first, ptrdiff_t n, Less lt) {
+    for (ptrdiff_t i = n - 1; i > 0; --i) {
+        auto value = std::move(first[i]);
+        first[i] = std::move(first[0]);
+        heapSiftDown<D>(first, i, 0, std::move(value), lt);
+    }
+}
+
+template <size_t D, typename RandomIt, typename Less>
+void heapSortWithArity(RandomIt first, RandomIt last, Less lt) {
+    makeHeap<D>(first, last - first, lt);
+    sortHeap<D>(first, last - first, lt);
+}
+
+// Heap sort over [first, last) with a ready-made record comparator (shared with IntroSort's fallback)
+template <typename RandomIt, typename Less>
+void heapSortRange(RandomIt first, RandomIt last, Less lt) {
+    switch (heapArity(sizeof(typename iterator_traits<RandomIt>::value_type))) {
+        case 4: heapSortWithArity<4>(first, last, lt); break;
+        case 8: heapSortWithArity<8>(first, last, lt); break;
+        default: heapSortWithArity<2>(first, last, lt); break;
+    }
+}
+
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void HeapSort(RandomIt first, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    heapSortRange(first, last, makeKeyLess(key, comp));
+}
+
+inline void HeapSort(vector<pair<int, int>>& arr) {
+    HeapSort(arr.begin(), arr.end());
+}
+REGISTER_RANGE_SORT(HeapSort, "Heap Sort", 0, HeapSort);
+
 // ------------------------------
 // Bubble Sort (Stable)
 // ------------------------------
@@ -90,6 +447,7 @@ inline void BubbleSort(vector<pair<int, int>>& arr) {
         }
     }
 }
+REGISTER_QUADRATIC_SORT(BubbleSort, "Bubble Sort", BubbleSort);
 
 // ------------------------------
 // Insertion Sort (Stable)
@@ -110,6 +468,7 @@ inline void InsertionSort(vector<pair<int, int>>& arr) {
         arr[j + 1] = key;
     }
 }
+REGISTER_QUADRATIC_SORT(InsertionSort, "Insertion Sort", InsertionSort);
 
 // ------------------------------
 // Selection Sort (Unstable)
@@ -130,46 +489,122 @@ inline void SelectionSort(vector<pair<int, int>>& arr) {
         swap(arr[i], arr[minIdx]);
     }
 }
+REGISTER_QUADRATIC_SORT(SelectionSort, "Selection Sort", SelectionSort);
 
 // ------------------------------
 // Quick Sort (Median-of-Three, Unstable)
 // ------------------------------
-inline int partition(vector<pair<int, int>>& arr, int low, int high) {
-    int mid = low + (high - low) / 2;
+// Partitions [first, last) around a median-of-three pivot and returns the pivot's final position
+template <typename RandomIt, typename Less>
+RandomIt partitionRange(RandomIt first, RandomIt last, Less lt) {
+    RandomIt low = first, high = last - 1;
+    RandomIt mid = low + (high - low) / 2;
 
     // Median-of-three pivot selection
-    if (arr[low].first > arr[mid].first) swap(arr[low], arr[mid]);
-    if (arr[low].first > arr[high].first) swap(arr[low], arr[high]);
-    if (arr[mid].first > arr[high].first) swap(arr[mid], arr[high]);
-    swap(arr[mid], arr[high]); // Move pivot to the end
+    if (lt(*mid, *low)) swap(*low, *mid);
+    if (lt(*high, *low)) swap(*low, *high);
+    if (lt(*high, *mid)) swap(*mid, *high);
+    swap(*mid, *high); // Move pivot to the end
 
-    auto pivot = arr[high];
-    int i = low - 1;
+    RandomIt i = low;
 
-    // Move elements smaller than pivot to the left
-    for (int j = low; j < high; ++j) {
-        if (arr[j].first <= pivot.first) {
+    // Move elements not greater than pivot to the left
+    for (RandomIt j = low; j != high; ++j) {
+        if (!lt(*high, *j)) {
+            swap(*i, *j);
             ++i;
-            swap(arr[i], arr[j]);
         }
     }
 
     // Place pivot in correct position
-    swap(arr[i + 1], arr[high]);
-    return i + 1;
+    swap(*i, *high);
+    return i;
 }
 
-inline void QuickSort(vector<pair<int, int>>& arr, int low, int high) {
-    while (low < high) {
-        int pi = partition(arr, low, high);
+inline int partition(vector<pair<int, int>>& arr, int low, int high) {
+    auto pivot = partitionRange(arr.begin() + low, arr.begin() + high + 1, makeKeyLess(FirstKey{}, less<>{}));
+    return static_cast<int>(pivot - arr.begin());
+}
+
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void QuickSort(RandomIt first, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    auto lt = makeKeyLess(key, comp);
+    while (last - first > 1) {
+        // Leaves small enough for one sorting network skip the remaining partitions
+        if (sortSmallRange(first, last, lt)) return;
+        RandomIt pi = partitionRange(first, last, lt);
 
         // Recur on smaller side first (tail recursion optimization)
-        if (pi - low < high - pi) {
-            QuickSort(arr, low, pi - 1);
-            low = pi + 1;
+        if (pi - first < last - pi) {
+            QuickSort(first, pi, key, comp);
+            first = pi + 1;
+        } else {
+            QuickSort(pi + 1, last, key, comp);
+            last = pi;
+        }
+    }
+}
+
+inline void QuickSort(vector<pair<int, int>>& arr, int low, int high) {
+    if (low >= high) return;
+    QuickSort(arr.begin() + low, arr.begin() + high + 1);
+}
+REGISTER_RANGE_SORT(QuickSort, "Quick Sort", 0, QuickSort);
+
+// ------------------------------
+// Vectorized Quick Sort (Unstable)
+// ------------------------------
+// Quick sort on (int, int) records whose partition step is partitionRecords: the keys of a whole
+// register are compared with the pivot at once and the records compress-stored to either side, so the
+// loop has no per-element branch to mispredict. The pivot (median of three) is excluded from its own
+// partition; a range whose pivot equals the record before it gathers that key on the left in one pass,
+// and after log2(n) badly unbalanced partitions the range is heap sorted. Small ranges go to the sorting
+// networks.
+inline void vectorizedQuickSortLoop(KeyRecord* first, KeyRecord* last, int badAllowed, bool leftmost) {
+    auto lt = makeKeyLess(FirstKey{}, less<>{});
+    while (true) {
+        ptrdiff_t n = last - first;
+        if (sortSmallRange(first, last, lt)) return;
+        if (badAllowed == 0) {
+            heapSortRange(first, last, lt);
+            return;
+        }
+
+        // Median-of-three pivot, moved to the front
+        KeyRecord *mid = first + n / 2, *back = last - 1;
+        if (lt(*mid, *first)) swap(*first, *mid);
+        if (lt(*back, *first)) swap(*first, *back);
+        if (lt(*back, *mid)) swap(*mid, *back);
+        swap(*first, *mid);
+        int pivot = first->first;
+
+        // Everything here is >= the record before the range; if that equals the pivot, so do all keys not above it
+        if (!leftmost && !(first[-1].first < pivot)) {
+            first = partitionRecords(first + 1, last, pivot, true);
+            continue;
+        }
+
+        KeyRecord* bound = partitionRecords(first + 1, last, pivot, false);
+        KeyRecord* pivotPos = bound - 1;
+        swap(*first, *pivotPos);
+        if (min(pivotPos - first, last - bound) < n / 8) --badAllowed;
+
+        // Recur on the smaller side, loop on the larger
+        if (pivotPos - first < last - bound) {
+            vectorizedQuickSortLoop(first, pivotPos, badAllowed, leftmost);
+            first = bound;
+            leftmost = false;
         } else {
-            QuickSort(arr, pi + 1, high);
-            high = pi - 1;
+            vectorizedQuickSortLoop(bound, last, badAllowed, false);
+            last = pivotPos;
         }
     }
 }
+
+inline void VectorizedQuickSort(vector<pair<int, int>>& arr) {
+    if (arr.size() < 2) return;
+    int badAllowed = 0;
+    for (size_t n = arr.size(); n > 1; n >>= 1) ++badAllowed;
+    vectorizedQuickSortLoop(arr.data(), arr.data() + arr.size(), badAllowed, true);
+}
+REGISTER_SORT(VectorizedQuickSort, "Vectorized Quick Sort", 0, VectorizedQuickSort);
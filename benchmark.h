@@ -0,0 +1,179 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+#include "alloc_counter.h"
+#include "cpu_affinity.h"
+#include "perf_counters.h"
+
+using namespace std;
+
+// ------------------------------
+// Timing
+// ------------------------------
+
+// Measure execution time in seconds
+template <typename Func, typename... Data>
+double measureExecutionTime(const Func& sortFunc, Data&... data) {
+    auto start = chrono::high_resolution_clock::now();
+    sortFunc(data...);
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration<double>(end - start).count();
+}
+
+// Times one sort; in counter mode also records its hardware counters into perf
+template <typename Func, typename... Data>
+double measureWithCounters(PerfSample& perf, const Func& sortFunc, Data&... data) {
+    if (!perfCountersEnabled()) return measureExecutionTime(sortFunc, data...);
+    PerfCounters& counters = harnessPerfCounters();
+    counters.start();
+    double time = measureExecutionTime(sortFunc, data...);
+    perf = counters.stop();
+    return time;
+}
+
+// ------------------------------
+// Benchmark Configuration
+// ------------------------------
+struct BenchmarkConfig {
+    int warmupRuns = 1;      // Unrecorded runs first: warm caches, branch predictors and lazy setup
+    int minRuns = 5;         // Runs before the confidence interval is checked
+    int maxRuns = 30;        // Hard cap on recorded runs
+    double targetCI = 0.01;  // Stop once the 95% CI half-width is within this fraction of the mean
+    double timeBudget = 5.0; // Seconds per cell, warmups included, after which repetition stops
+    int pinCpu = firstAllowedCpu(); // CPU the harness thread is pinned to; -1 leaves placement to the OS
+};
+
+inline BenchmarkConfig& benchmarkConfig() {
+    static BenchmarkConfig config;
+    return config;
+}
+
+// ------------------------------
+// Run Statistics
+// ------------------------------
+struct BenchmarkStats {
+    int runs = 0;
+    double mean = 0, median = 0, p90 = 0, p99 = 0, min = 0, stddev = 0;
+    double ciHalfWidth = 0; // 95% confidence interval of the mean is mean +- this
+};
+
+// Two-sided 95% Student t quantile for df degrees of freedom
+inline double studentT95(int df) {
+    static const double table[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df < 1) return 0;
+    return df <= 30 ? table[df - 1] : 1.96;
+}
+
+inline BenchmarkStats summarizeTimes(vector<double> times) {
+    BenchmarkStats stats;
+    stats.runs = static_cast<int>(times.size());
+    if (times.empty()) return stats;
+    sort(times.begin(), times.end());
+
+    // Nearest-rank percentiles
+    auto percentile = [&](double p) {
+        size_t rank = static_cast<size_t>(ceil(p * times.size()));
+        return times[max<size_t>(rank, 1) - 1];
+    };
+    stats.min = times.front();
+    stats.median = percentile(0.5);
+    stats.p90 = percentile(0.9);
+    stats.p99 = percentile(0.99);
+
+    double sum = 0;
+    for (double t : times) sum += t;
+    stats.mean = sum / times.size();
+    if (times.size() > 1) {
+        double sq = 0;
+        for (double t : times) sq += (t - stats.mean) * (t - stats.mean);
+        stats.stddev = sqrt(sq / (times.size() - 1));
+        stats.ciHalfWidth = studentT95(stats.runs - 1) * stats.stddev / sqrt(static_cast<double>(times.size()));
+    }
+    return stats;
+}
+
+// ------------------------------
+// Benchmark Engine
+// ------------------------------
+template <typename T = pair<int, int>>
+struct BenchmarkResult {
+    BenchmarkStats time;
+    AllocationStats heap;              // From the last run
+    PerfSample perf;                   // From the last run
+    vector<T> output;                  // Output of the last run (runBenchmarkInPlace leaves it empty)
+};
+
+// Warmups, then repetitions until the CI target, maxRuns or the time budget is hit. runOnce() performs and
+// times one run, recording its heap and counters into result.
+template <typename T, typename RunOnce>
+void repeatRuns(BenchmarkResult<T>& result, const BenchmarkConfig& config, RunOnce runOnce) {
+    double spent = 0;
+    vector<double> times;
+    for (int i = 0; i < config.warmupRuns; ++i) {
+        double t = runOnce();
+        spent += t;
+
+        // A warmup that alone exhausts the budget (a quadratic sort at large n) is kept as the only run
+        if (spent >= config.timeBudget) {
+            result.time = summarizeTimes({t});
+            return;
+        }
+    }
+
+    while (true) {
+        times.push_back(runOnce());
+        spent += times.back();
+        int runs = static_cast<int>(times.size());
+        if (runs >= config.maxRuns || spent >= config.timeBudget) break;
+        if (runs >= config.minRuns) {
+            BenchmarkStats stats = summarizeTimes(times);
+            if (stats.ciHalfWidth <= config.targetCI * stats.mean) break;
+        }
+    }
+
+    result.time = summarizeTimes(times);
+}
+
+// Times sortFunc on input with repeatRuns.
+// Every run sorts a fresh copy in one buffer that is faulted in up front, so no run pays for page faults.
+template <typename Func, typename T>
+BenchmarkResult<T> runBenchmark(const Func& sortFunc, const vector<T>& input,
+                                const BenchmarkConfig& config = benchmarkConfig()) {
+    BenchmarkResult<T> result;
+    vector<T>& work = result.output;
+    work.assign(input.size(), {});
+
+    repeatRuns(result, config, [&] {
+        copy(input.begin(), input.end(), work.begin());
+        AllocationTracker tracker;
+        double t = measureWithCounters(result.perf, sortFunc, work);
+        result.heap = tracker.stop();
+        return t;
+    });
+    return result;
+}
+
+// Times sortFunc(first, last) with repeatRuns, sorting the records where they are (a mapped dataset) rather
+// than a copy. restore() puts the input back before each run, off the clock; the output is left in
+// [first, last) and result.output stays empty.
+template <typename Func, typename T, typename Restore>
+BenchmarkResult<T> runBenchmarkInPlace(const Func& sortFunc, T* first, T* last, Restore restore,
+                                       const BenchmarkConfig& config = benchmarkConfig()) {
+    BenchmarkResult<T> result;
+    repeatRuns(result, config, [&] {
+        restore();
+        AllocationTracker tracker;
+        double t = measureWithCounters(result.perf, sortFunc, first, last);
+        result.heap = tracker.stop();
+        return t;
+    });
+    return result;
+}
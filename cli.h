@@ -0,0 +1,364 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "benchmark.h"
+#include "external_sort.h"
+#include "input_generator.h"
+#include "result_writer.h"
+#include "simd_sort.h"
+#include "sort_registry.h"
+#include "test.h"
+
+using namespace std;
+
+// ------------------------------
+// Run Options
+// ------------------------------
+struct RunOptions {
+    vector<string> algorithms; // Case-insensitive name filters; a sort runs if its name contains any. Empty = all
+    vector<int> sizes = {1000, 10000, 100000, 1000000};
+    vector<string> inputTypes = {"Sorted", "ReverseSorted", "Random", "PartiallySorted"}; // "Name" or "Name:param"
+    uint64_t seed = 1;         // Seed of every generated input; the same seed reproduces the same inputs
+    vector<string> datasets;   // Dataset files to sort instead of generated inputs
+    string datasetDir;         // If set, write each generated size x input type here as a dataset file and exit
+    unsigned threads = 0;      // Threads for the parallel sorts; 0 = all hardware threads
+    SimdLevel simd = detectSimdLevel(); // Instruction set for the SIMD leaf kernels, at most the CPU's
+    bool simdMerge = false;    // Merge sorts' interleaved merges of (int, int) records go through the SIMD kernel
+    size_t heapArity = 0;      // Children per node of the heap sorts' heaps; 0 = as many as fill a cache line
+    string autoProfilePath;    // Auto Sort profile to load; empty = built-in thresholds
+    string tunePath;           // If set, tune the Auto Sort profile over the sizes, write it here and exit
+    string outputPath = "results.csv";
+    OutputFormat format = OutputFormat::Csv;
+    double cellBudget = 0;     // Seconds per (algorithm, size, input) cell; 0 = unlimited
+    bool stability = true;
+    bool counters = false;
+    bool inversions = false;   // Opt-in inversion counts before and after each sort
+    vector<size_t> layoutRecordBytes; // Record sizes for the AoS vs SoA comparison; empty = regular run
+    vector<size_t> smallArrayLengths; // Lengths for the small-array batches; empty = regular run
+    vector<size_t> ingestBatches; // Batch sizes for the incremental ingest benchmarks; empty = regular run
+    vector<size_t> topK;       // k values (SELECT_MEDIAN = the median) for the selection benchmarks; empty = regular run
+    bool external = false;     // Sort through files with externalSort, each selected sort forming the runs
+    ExternalSortConfig externalConfig;
+    bool list = false;
+    bool help = false;
+};
+
+inline void printUsage(const char* program) {
+    cout << "Usage: " << program << " [options]\n"
+         << "  --algorithms=A,B      Run sorts whose name contains A or B (case-insensitive)\n"
+         << "  --list                List registered sorts and exit\n"
+         << "  --sizes=N,...         Input sizes; k/M/G suffixes and 1e7 notation accepted\n"
+         << "  --inputs=T,...        Input types, each optionally as Type:param (see below)\n"
+         << "  --seed=N              Seed for the generated inputs (default 1)\n"
+         << "  --dataset=PATH,...    Sort these dataset files instead of generated inputs\n"
+         << "  --write-datasets=DIR  Write each size x input type to DIR as a dataset file, then exit\n"
+         << "  --reps=N              N measured runs per cell (fewer if --time-budget runs out first)\n"
+         << "  --min-runs=N          Runs before the confidence interval is checked\n"
+         << "  --max-runs=N          Cap on measured runs per cell\n"
+         << "  --warmup=N            Unrecorded runs before measuring\n"
+         << "  --target-ci=F         Stop once the 95% CI half-width is within F of the mean\n"
+         << "  --threads=N           Threads for the parallel sorts\n"
+         << "  --pin=CPU             Pin the harness to CPU (default: first allowed CPU; -1 = no pinning)\n"
+         << "  --simd=LEVEL          SIMD kernels: avx512, avx2, sse4.2 or scalar (default: best the CPU has)\n"
+         << "  --simd-merge          Merge and Tim Sort merge interleaved runs with the SIMD merge kernel\n"
+         << "  --heap-arity=N        Children per node in the heap sorts: 2, 4 or 8 (default: a cache line)\n"
+         << "  --auto-profile=PATH   Auto Sort thresholds from a profile written by --tune\n"
+         << "  --tune=PATH           Time Auto Sort's engines over the sizes (>= " << AUTO_SORT_MIN_PROBE << ") and inputs,\n"
+         << "                        write the thresholds they favour to PATH as a profile, then exit\n"
+         << "  --output=PATH         Output file (default results.csv)\n"
+         << "  --format=csv|json     CSV, or JSON Lines with one object per row\n"
+         << "  --time-budget=SEC     Seconds per cell: repetition stops there, and cells predicted\n"
+         << "                        to exceed it from the previous size are skipped\n"
+         << "  --no-stability        Skip the stability pass\n"
+         << "  --counters            Collect hardware performance counters\n"
+         << "  --inversions          Also count inversions before and after each sort (slow)\n"
+         << "  --layout=BYTES,...    Compare AoS and SoA (packed key + index) layouts at these record sizes\n"
+         << "                        instead of the regular run: 16, 32, 64, 128, 256 or 512\n"
+         << "  --small-arrays=N,...  Sort the input as independent N-record arrays (N = 2..32) with the\n"
+         << "                        small-range engines instead of the regular run\n"
+         << "  --top-k=K,...         Time selection instead of the regular run: the K smallest records, sorted,\n"
+         << "                        by each selection engine and by a full sort; K = median finds the median\n"
+         << "  --ingest=BATCH,...    Feed each input in batches of BATCH records with range queries in between,\n"
+         << "                        to the sorted run log and to re-sorting, instead of the regular run\n"
+         << "  --external            External merge sort through files; the selected sorts form the runs\n"
+         << "  --memory-budget=SIZE  External sort memory in bytes, k/M/G suffixes accepted (default " << (EXTERNAL_MEMORY_BUDGET >> 20) << "M)\n"
+         << "  --fan-in=N            Runs merged per external merge pass (default " << EXTERNAL_FAN_IN << ")\n"
+         << "  --temp-dir=PATH       Directory for external sort runs (default $TMPDIR or /tmp)\n"
+         << "\nInput types:\n";
+    for (const auto& dist : inputDistributions()) {
+        cout << "  " << dist.name;
+        if (!dist.param.empty()) cout << string(max<size_t>(1, 22 - dist.name.size()), ' ') << "param: " << dist.param;
+        cout << "\n";
+    }
+}
+
+// Splits "a,b,c" on commas, dropping empty items
+inline vector<string> splitList(const string& s) {
+    vector<string> items;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t end = s.find(',', start);
+        if (end == string::npos) end = s.size();
+        if (end > start) items.push_back(s.substr(start, end - start));
+        start = end + 1;
+    }
+    return items;
+}
+
+// Parses "1000", "100k", "10M", "1e7"; returns -1 if malformed or outside [1, maxValue]
+inline long long parseSize(const string& s, long long maxValue = INT_MAX) {
+    char* end = nullptr;
+    double value = strtod(s.c_str(), &end);
+    if (end == s.c_str()) return -1;
+    string suffix = end;
+    if (suffix == "k" || suffix == "K") value *= 1e3;
+    else if (suffix == "m" || suffix == "M") value *= 1e6;
+    else if (suffix == "g" || suffix == "G") value *= 1e9;
+    else if (!suffix.empty()) return -1;
+    if (value < 1 || value > maxValue) return -1;
+    return static_cast<long long>(value);
+}
+
+inline string toLower(string s) {
+    for (char& c : s) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    return s;
+}
+
+// Fills options (and the global benchmark config) from argv; on failure returns false and sets error
+inline bool parseRunOptions(int argc, char** argv, RunOptions& options, string& error) {
+    BenchmarkConfig& bench = benchmarkConfig();
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string flag = arg.substr(0, eq);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+        bool hasValue = eq != string::npos && !value.empty();
+
+        auto intValue = [&](int& out, int lo) {
+            char* end = nullptr;
+            long v = strtol(value.c_str(), &end, 10);
+            if (!hasValue || *end != '\0' || v < lo || v > INT_MAX) {
+                error = "bad value for " + flag + ": '" + value + "'";
+                return false;
+            }
+            out = static_cast<int>(v);
+            return true;
+        };
+        auto doubleValue = [&](double& out) {
+            char* end = nullptr;
+            double v = strtod(value.c_str(), &end);
+            if (!hasValue || *end != '\0' || v < 0) {
+                error = "bad value for " + flag + ": '" + value + "'";
+                return false;
+            }
+            out = v;
+            return true;
+        };
+
+        if (flag == "--help" || flag == "-h") {
+            options.help = true;
+        } else if (flag == "--list") {
+            options.list = true;
+        } else if (flag == "--no-stability") {
+            options.stability = false;
+        } else if (flag == "--counters") {
+            options.counters = true;
+        } else if (flag == "--inversions") {
+            options.inversions = true;
+        } else if (flag == "--simd-merge") {
+            options.simdMerge = true;
+        } else if (flag == "--layout") {
+            if (!hasValue) {
+                error = "--layout needs at least one record size";
+                return false;
+            }
+            options.layoutRecordBytes.clear();
+            for (const string& item : splitList(value)) {
+                char* end = nullptr;
+                size_t bytes = strtoul(item.c_str(), &end, 10);
+                const auto& known = layoutRecordSizes();
+                if (*end != '\0' || find(known.begin(), known.end(), bytes) == known.end()) {
+                    string sizes;
+                    for (size_t k : known) sizes += (sizes.empty() ? "" : ", ") + to_string(k);
+                    error = "unsupported record size '" + item + "' for --layout (" + sizes + ")";
+                    return false;
+                }
+                options.layoutRecordBytes.push_back(bytes);
+            }
+        } else if (flag == "--small-arrays") {
+            options.smallArrayLengths.clear();
+            for (const string& item : splitList(value)) {
+                char* end = nullptr;
+                unsigned long length = strtoul(item.c_str(), &end, 10);
+                if (*end != '\0' || length < 2 || length > SORTING_NETWORK_MAX) {
+                    error = "bad array length '" + item + "' for --small-arrays (2.." + to_string(SORTING_NETWORK_MAX) + ")";
+                    return false;
+                }
+                options.smallArrayLengths.push_back(length);
+            }
+        } else if (flag == "--ingest") {
+            options.ingestBatches.clear();
+            for (const string& item : splitList(value)) {
+                long long batch = parseSize(item);
+                if (batch < 0) {
+                    error = "bad batch size '" + item + "' for --ingest";
+                    return false;
+                }
+                options.ingestBatches.push_back(batch);
+            }
+        } else if (flag == "--top-k") {
+            options.topK.clear();
+            for (const string& item : splitList(value)) {
+                long long k = item == "median" ? SELECT_MEDIAN : parseSize(item);
+                if (k < 0) {
+                    error = "bad value '" + item + "' for --top-k";
+                    return false;
+                }
+                options.topK.push_back(k);
+            }
+        } else if (flag == "--external") {
+            options.external = true;
+        } else if (flag == "--memory-budget") {
+            long long bytes = parseSize(value, LLONG_MAX / 2);
+            if (bytes < 0) {
+                error = "bad value for --memory-budget: '" + value + "'";
+                return false;
+            }
+            options.externalConfig.memoryBudget = bytes;
+        } else if (flag == "--fan-in") {
+            int fanIn = 0;
+            if (!intValue(fanIn, 2)) return false;
+            options.externalConfig.fanIn = fanIn;
+        } else if (flag == "--temp-dir") {
+            if (!hasValue) {
+                error = "--temp-dir needs a path";
+                return false;
+            }
+            options.externalConfig.tempDir = value;
+        } else if (flag == "--algorithms") {
+            options.algorithms = splitList(value);
+        } else if (flag == "--sizes") {
+            options.sizes.clear();
+            for (const string& item : splitList(value)) {
+                long long size = parseSize(item);
+                if (size < 0) {
+                    error = "bad size '" + item + "'";
+                    return false;
+                }
+                options.sizes.push_back(static_cast<int>(size));
+            }
+        } else if (flag == "--inputs") {
+            options.inputTypes = splitList(value);
+            for (const string& type : options.inputTypes) {
+                if (!findInputDistribution(type).dist) {
+                    error = "unknown input type '" + type + "'";
+                    return false;
+                }
+            }
+        } else if (flag == "--dataset") {
+            options.datasets = splitList(value);
+        } else if (flag == "--write-datasets") {
+            if (!hasValue) {
+                error = "--write-datasets needs a directory";
+                return false;
+            }
+            options.datasetDir = value;
+        } else if (flag == "--seed") {
+            char* end = nullptr;
+            unsigned long long seed = strtoull(value.c_str(), &end, 10);
+            if (!hasValue || *end != '\0') {
+                error = "bad value for --seed: '" + value + "'";
+                return false;
+            }
+            options.seed = seed;
+        } else if (flag == "--reps") {
+            if (!intValue(bench.maxRuns, 1)) return false;
+            bench.minRuns = bench.maxRuns;
+        } else if (flag == "--min-runs") {
+            if (!intValue(bench.minRuns, 1)) return false;
+        } else if (flag == "--max-runs") {
+            if (!intValue(bench.maxRuns, 1)) return false;
+        } else if (flag == "--warmup") {
+            if (!intValue(bench.warmupRuns, 0)) return false;
+        } else if (flag == "--target-ci") {
+            if (!doubleValue(bench.targetCI)) return false;
+        } else if (flag == "--threads") {
+            int threads = 0;
+            if (!intValue(threads, 1)) return false;
+            options.threads = threads;
+        } else if (flag == "--pin") {
+            if (!intValue(bench.pinCpu, -1)) return false;
+        } else if (flag == "--simd") {
+            if (value == "avx512") options.simd = SimdLevel::Avx512;
+            else if (value == "avx2") options.simd = SimdLevel::Avx2;
+            else if (value == "sse4.2") options.simd = SimdLevel::Sse42;
+            else if (value == "scalar") options.simd = SimdLevel::Scalar;
+            else {
+                error = "unknown SIMD level '" + value + "' (avx512, avx2, sse4.2 or scalar)";
+                return false;
+            }
+        } else if (flag == "--heap-arity") {
+            if (value == "2" || value == "4" || value == "8") options.heapArity = stoul(value);
+            else {
+                error = "bad value for --heap-arity: '" + value + "' (2, 4 or 8)";
+                return false;
+            }
+        } else if (flag == "--auto-profile" || flag == "--tune") {
+            if (!hasValue) {
+                error = flag + " needs a path";
+                return false;
+            }
+            (flag == "--tune" ? options.tunePath : options.autoProfilePath) = value;
+        } else if (flag == "--output") {
+            if (!hasValue) {
+                error = "--output needs a path";
+                return false;
+            }
+            options.outputPath = value;
+        } else if (flag == "--format") {
+            if (value == "csv") options.format = OutputFormat::Csv;
+            else if (value == "json") options.format = OutputFormat::Json;
+            else {
+                error = "unknown format '" + value + "' (csv or json)";
+                return false;
+            }
+        } else if (flag == "--time-budget") {
+            if (!doubleValue(options.cellBudget)) return false;
+            if (options.cellBudget > 0) bench.timeBudget = options.cellBudget;
+        } else {
+            error = "unknown option '" + arg + "'";
+            return false;
+        }
+    }
+
+    bench.minRuns = min(bench.minRuns, bench.maxRuns);
+    if (options.sizes.empty() || options.inputTypes.empty()) {
+        error = "need at least one size and one input type";
+        return false;
+    }
+    return true;
+}
+
+// True if name passes the --algorithms filters
+inline bool algorithmSelected(const RunOptions& options, const string& name) {
+    bool match = options.algorithms.empty();
+    for (const string& filter : options.algorithms)
+        match = match || toLower(name).find(toLower(filter)) != string::npos;
+    return match;
+}
+
+// Registered sorts matching the --algorithms filters, in registration order
+inline vector<SortEntry> selectSorts(const RunOptions& options) {
+    vector<SortEntry> selected;
+    for (const SortEntry& entry : sortRegistry())
+        if (algorithmSelected(options, entry.name)) selected.push_back(entry);
+    return selected;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include <sched.h>
+
+using namespace std;
+
+// ------------------------------
+// CPU Affinity
+// ------------------------------
+// CPUs the process was allowed at startup (taskset, cgroup cpusets), ascending. Captured before
+// any pinning below narrows the calling thread's mask.
+inline const vector<int>& allowedCpus() {
+    static const vector<int> cpus = [] {
+        vector<int> result;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &set)) result.push_back(cpu);
+        }
+        if (result.empty()) result.push_back(0);
+        return result;
+    }();
+    return cpus;
+}
+
+inline int firstAllowedCpu() { return allowedCpus().front(); }
+
+// The allowed CPU `steps` places on from cpu (or from the next allowed one after it), wrapping around
+inline int allowedCpuAfter(int cpu, unsigned steps) {
+    const vector<int>& cpus = allowedCpus();
+    size_t pos = lower_bound(cpus.begin(), cpus.end(), cpu) - cpus.begin();
+    return cpus[(pos + steps) % cpus.size()];
+}
+
+// Restricts the calling thread to one allowed CPU (cpu itself if allowed); returns false if the OS refused
+inline bool pinCurrentThreadToCpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(allowedCpuAfter(cpu, 0), &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+// Lets the calling thread run on any CPU the process was allowed again
+inline void unpinCurrentThread() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : allowedCpus()) CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+}
@@ -0,0 +1,234 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "input_generator.h"
+
+using namespace std;
+
+using Record = pair<int, int>;
+
+// ------------------------------
+// Raw File I/O
+// ------------------------------
+// read()/write() until done, EOF or error; returns bytes moved, or -1 on error
+inline ssize_t readFully(int fd, void* dst, size_t bytes) {
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t got = read(fd, static_cast<char*>(dst) + done, bytes - done);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) return -1;
+        if (got == 0) break;
+        done += got;
+    }
+    return done;
+}
+
+inline ssize_t writeFully(int fd, const void* src, size_t bytes) {
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t put = write(fd, static_cast<const char*>(src) + done, bytes - done);
+        if (put < 0 && errno == EINTR) continue;
+        if (put < 0) return -1;
+        done += put;
+    }
+    return done;
+}
+
+// ------------------------------
+// Dataset File Format
+// ------------------------------
+// A 128-byte header followed by count packed records (int32 key, int32 original index), native byte
+// order. The records start at headerSize, so a mapping of the file is directly a Record array.
+const char DATASET_MAGIC[8] = {'S', 'O', 'R', 'T', 'D', 'A', 'T', 'A'};
+const uint32_t DATASET_VERSION = 1;
+const uint32_t DATASET_BYTE_ORDER = 0x01020304; // Reads back differently on a host of the other endianness
+
+struct DatasetHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t headerSize;     // Offset of the first record
+    uint32_t recordSize;     // Bytes per record
+    uint32_t keyWidth;       // Bytes of the key at the start of each record
+    uint32_t reserved;
+    uint64_t count;          // Records in the file
+    uint64_t seed;           // Generator seed, or 0 for captured data
+    char provenance[80];     // Where the data came from, e.g. "Zipf:1.2" or "capture 2026-10-01"; NUL-padded
+};
+static_assert(sizeof(DatasetHeader) == 128, "dataset header layout is part of the file format");
+
+inline DatasetHeader makeDatasetHeader(uint64_t count, uint64_t seed, const string& provenance) {
+    DatasetHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DATASET_MAGIC, sizeof(header.magic));
+    header.version = DATASET_VERSION;
+    header.byteOrder = DATASET_BYTE_ORDER;
+    header.headerSize = sizeof(DatasetHeader);
+    header.recordSize = sizeof(Record);
+    header.keyWidth = sizeof(Record::first_type);
+    header.count = count;
+    header.seed = seed;
+    strncpy(header.provenance, provenance.c_str(), sizeof(header.provenance) - 1);
+    return header;
+}
+
+inline string datasetProvenance(const DatasetHeader& header) {
+    return string(header.provenance, strnlen(header.provenance, sizeof(header.provenance)));
+}
+
+// Checks a header against this build's record layout and the file's size; sets error if unusable
+inline bool validateDatasetHeader(const DatasetHeader& header, uint64_t fileSize, string& error) {
+    if (memcmp(header.magic, DATASET_MAGIC, sizeof(header.magic)) != 0) error = "not a dataset file";
+    else if (header.byteOrder != DATASET_BYTE_ORDER) error = "dataset was written with the other byte order";
+    else if (header.version != DATASET_VERSION) error = "unsupported dataset version " + to_string(header.version);
+    else if (header.recordSize != sizeof(Record) || header.keyWidth != sizeof(Record::first_type))
+        error = "dataset records are " + to_string(header.recordSize) + " bytes with " + to_string(header.keyWidth)
+              + "-byte keys; this build sorts " + to_string(sizeof(Record)) + "-byte records";
+    else if (header.headerSize < sizeof(DatasetHeader) || header.headerSize % alignof(Record))
+        error = "bad dataset header size";
+    else if (fileSize < header.headerSize || (fileSize - header.headerSize) / sizeof(Record) < header.count)
+        error = "dataset is truncated";
+    else return true;
+    return false;
+}
+
+// Reads and validates the header of an open dataset file, leaving the offset at the first record
+inline bool readDatasetHeader(int fd, DatasetHeader& header, string& error) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || readFully(fd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header))) {
+        error = "cannot read dataset header";
+        return false;
+    }
+    if (!validateDatasetHeader(header, st.st_size, error)) return false;
+    return lseek(fd, header.headerSize, SEEK_SET) == static_cast<off_t>(header.headerSize);
+}
+
+// ------------------------------
+// Mapped Dataset
+// ------------------------------
+// A dataset file mapped copy-on-write: opening costs no read and no parse, records fault in as they are
+// touched, and a file larger than memory can be streamed through without being loaded. Engines can sort
+// the records in place; writes stay private to the process and restore() brings the file's order back.
+class MappedDataset {
+public:
+    MappedDataset() = default;
+    ~MappedDataset() { unmap(); }
+
+    MappedDataset(const MappedDataset&) = delete;
+    MappedDataset& operator=(const MappedDataset&) = delete;
+
+    bool open(const string& path, string& error) {
+        unmap();
+        errno = 0;
+        int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(DatasetHeader)) {
+            error = "cannot open dataset " + path + (errno ? string(": ") + strerror(errno) : "");
+            if (fd >= 0) close(fd);
+            return false;
+        }
+        length = st.st_size;
+        base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd); // The mapping keeps the file referenced
+        if (base == MAP_FAILED) {
+            base = nullptr;
+            error = "cannot map dataset " + path + ": " + strerror(errno);
+            return false;
+        }
+        if (!validateDatasetHeader(header(), length, error)) {
+            error = path + ": " + error;
+            unmap();
+            return false;
+        }
+        return true;
+    }
+
+    const DatasetHeader& header() const { return *static_cast<const DatasetHeader*>(base); }
+    size_t size() const { return header().count; }
+    Record* begin() { return reinterpret_cast<Record*>(static_cast<char*>(base) + header().headerSize); }
+    Record* end() { return begin() + size(); }
+    const Record* begin() const {
+        return reinterpret_cast<const Record*>(static_cast<const char*>(base) + header().headerSize);
+    }
+    const Record* end() const { return begin() + size(); }
+
+    // Drops the private copies of written pages, so the records read as the file again, then writes to
+    // every page so the next in-place sort takes no copy-on-write faults
+    void restore() {
+        if (!base) return;
+        madvise(base, length, MADV_DONTNEED);
+        size_t page = sysconf(_SC_PAGESIZE);
+        volatile char* bytes = static_cast<char*>(base);
+        for (size_t offset = 0; offset < length; offset += page) bytes[offset] = bytes[offset];
+    }
+
+    // Hints the kernel to read ahead; sorts that sweep the data once benefit, random access does not
+    void adviseSequential() { if (base) madvise(base, length, MADV_SEQUENTIAL); }
+
+private:
+    void unmap() {
+        if (base) munmap(base, length);
+        base = nullptr;
+        length = 0;
+    }
+
+    void* base = nullptr;
+    size_t length = 0;
+};
+
+// ------------------------------
+// Dataset Writers
+// ------------------------------
+// Writes header and records to a new dataset file
+inline bool writeDataset(const string& path, const Record* records, size_t count, uint64_t seed,
+                         const string& provenance, string& error) {
+    DatasetHeader header = makeDatasetHeader(count, seed, provenance);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0 && writeFully(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header))
+           && writeFully(fd, records, count * sizeof(Record)) == static_cast<ssize_t>(count * sizeof(Record));
+    if (fd >= 0) ok = close(fd) == 0 && ok;
+    if (!ok) error = "cannot write " + path + (errno ? string(": ") + strerror(errno) : "");
+    return ok;
+}
+
+// Generates a distribution straight into a mapped dataset file, without an in-memory copy of the data
+inline bool generateDataset(const string& path, const string& inputType, size_t count, uint64_t seed, string& error) {
+    InputSpec spec = findInputDistribution(inputType);
+    if (!spec.dist) {
+        error = "unknown input type '" + inputType + "'";
+        return false;
+    }
+
+    size_t length = sizeof(DatasetHeader) + count * sizeof(Record);
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, length) != 0) {
+        error = "cannot write " + path + ": " + strerror(errno);
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        error = "cannot map " + path + ": " + strerror(errno);
+        return false;
+    }
+
+    DatasetHeader header = makeDatasetHeader(count, seed, inputType);
+    memcpy(base, &header, sizeof(header));
+    fillRecords(spec, reinterpret_cast<Record*>(static_cast<char*>(base) + sizeof(header)), count, seed);
+    bool ok = msync(base, length, MS_SYNC) == 0;
+    munmap(base, length);
+    if (!ok) error = "cannot write " + path + ": " + strerror(errno);
+    return ok;
+}
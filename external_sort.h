@@ -0,0 +1,309 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "advanced_sorts.h"
+#include "dataset_file.h"
+#include "sort_registry.h"
+
+using namespace std;
+
+// ------------------------------
+// Buffered Record I/O
+// ------------------------------
+// Runs are raw records; the input and output files are datasets (dataset_file.h)
+struct IoCounters {
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+};
+
+// Reads up to count records into dst; returns the number read, or -1 on an I/O error or partial record
+inline ssize_t readRecords(int fd, Record* dst, size_t count, IoCounters& io) {
+    ssize_t got = readFully(fd, dst, count * sizeof(Record));
+    if (got < 0 || got % sizeof(Record)) return -1;
+    io.bytesRead += got;
+    return got / sizeof(Record);
+}
+
+inline bool writeRecords(int fd, const Record* src, size_t count, IoCounters& io) {
+    size_t bytes = count * sizeof(Record);
+    if (writeFully(fd, src, bytes) != static_cast<ssize_t>(bytes)) return false;
+    io.bytesWritten += bytes;
+    return true;
+}
+
+// Sequential reader over a record file through one large buffer
+class RecordReader {
+public:
+    RecordReader(size_t bufferRecords, IoCounters& io) : buffer(max<size_t>(1, bufferRecords)), io(io) {}
+    ~RecordReader() { if (fd >= 0) close(fd); }
+
+    RecordReader(const RecordReader&) = delete;
+    RecordReader& operator=(const RecordReader&) = delete;
+
+    bool open(const string& path) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        refill();
+        return !failed;
+    }
+
+    bool done() const { return pos == len; }
+    bool ok() const { return !failed; }
+    Record& current() { return buffer[pos]; }
+    void advance() { if (++pos == len) refill(); }
+
+    // Input iterator over the remaining records; a default-constructed cursor is the end
+    class Cursor {
+    public:
+        Cursor(RecordReader* reader = nullptr) : reader(reader) {}
+        Record& operator*() const { return reader->current(); }
+        Cursor& operator++() { reader->advance(); return *this; }
+        bool operator==(const Cursor& other) const { return atEnd() == other.atEnd() && (atEnd() || reader == other.reader); }
+        bool operator!=(const Cursor& other) const { return !(*this == other); }
+
+    private:
+        bool atEnd() const { return !reader || reader->done(); }
+        RecordReader* reader;
+    };
+    Cursor begin() { return Cursor(this); }
+    Cursor end() { return Cursor(); }
+
+private:
+    void refill() {
+        ssize_t got = readRecords(fd, buffer.data(), buffer.size(), io);
+        failed = failed || got < 0;
+        len = got > 0 ? got : 0;
+        pos = 0;
+    }
+
+    vector<Record> buffer;
+    IoCounters& io;
+    int fd = -1;
+    size_t pos = 0, len = 0;
+    bool failed = false;
+};
+
+// Sequential writer through one large buffer; close() flushes and reports any error
+class RecordWriter {
+public:
+    RecordWriter(size_t bufferRecords, IoCounters& io) : io(io) { buffer.reserve(max<size_t>(1, bufferRecords)); }
+    ~RecordWriter() { close(); }
+
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+
+    // Dataset outputs pass their header, written ahead of the records
+    bool open(const string& path, const DatasetHeader* header = nullptr) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        failed = header && writeFully(fd, header, sizeof(*header)) != static_cast<ssize_t>(sizeof(*header));
+        return !failed;
+    }
+
+    void put(const Record& rec) {
+        buffer.push_back(rec);
+        if (buffer.size() == buffer.capacity()) flush();
+    }
+
+    bool close() {
+        if (fd < 0) return !failed;
+        flush();
+        failed = ::close(fd) != 0 || failed;
+        fd = -1;
+        return !failed;
+    }
+
+    // Output iterator appending to the file, for kWayMerge
+    class Inserter {
+    public:
+        explicit Inserter(RecordWriter* writer) : writer(writer) {}
+        Inserter& operator*() { return *this; }
+        Inserter& operator++() { return *this; }
+        Inserter& operator++(int) { return *this; }
+        Inserter& operator=(const Record& rec) { writer->put(rec); return *this; }
+
+    private:
+        RecordWriter* writer;
+    };
+    Inserter inserter() { return Inserter(this); }
+
+private:
+    void flush() {
+        if (!buffer.empty() && !writeRecords(fd, buffer.data(), buffer.size(), io)) failed = true;
+        buffer.clear();
+    }
+
+    vector<Record> buffer;
+    IoCounters& io;
+    int fd = -1;
+    bool failed = false;
+};
+
+// ------------------------------
+// External Merge Sort
+// ------------------------------
+const size_t EXTERNAL_MEMORY_BUDGET = size_t(64) << 20; // Default budget
+const size_t EXTERNAL_FAN_IN = 64;                      // Default runs merged per pass
+const size_t EXTERNAL_MIN_BUFFER = size_t(64) << 10;    // Merge buffer bytes below which the fan-in is lowered
+const size_t EXTERNAL_BUFFER_OVERHEAD = 512;            // Reader/writer bookkeeping (object, path, heap slack) per buffer
+
+struct ExternalSortConfig {
+    size_t memoryBudget = EXTERNAL_MEMORY_BUDGET; // Heap bytes at once: a run plus runSort's scratch, or all merge buffers
+    size_t fanIn = EXTERNAL_FAN_IN;               // Most runs merged per pass
+    string tempDir;                               // Empty = $TMPDIR, else /tmp
+    SortFunction runSort;                         // In-memory engine for each run; empty = Tim Sort (stable)
+    double runScratch = 0.5;                      // runSort's heap beyond a run, per run byte (SortEntry::scratch)
+};
+
+// Throughputs are I/O bytes (read + written) per second of each phase
+struct ExternalSortStats {
+    size_t records = 0;
+    size_t runs = 0;          // Sorted runs written by run formation
+    size_t mergePasses = 0;   // Passes over the data after run formation
+    IoCounters runIo, mergeIo;
+    double runPhaseTime = 0, mergePhaseTime = 0;
+
+    uint64_t bytesRead() const { return runIo.bytesRead + mergeIo.bytesRead; }
+    uint64_t bytesWritten() const { return runIo.bytesWritten + mergeIo.bytesWritten; }
+    double runPhaseMBps() const { return throughput(runIo, runPhaseTime); }
+    double mergePhaseMBps() const { return throughput(mergeIo, mergePhaseTime); }
+
+private:
+    static double throughput(const IoCounters& io, double seconds) {
+        return seconds > 0 ? (io.bytesRead + io.bytesWritten) / seconds / 1e6 : 0.0;
+    }
+};
+
+inline string externalTempDir(const string& configured) {
+    if (!configured.empty()) return configured;
+    const char* env = getenv("TMPDIR");
+    return env && *env ? env : "/tmp";
+}
+
+// Sorts the dataset file at inputPath into a dataset at outputPath (stable if runSort is). Chunks sized so
+// that a chunk plus runSort's scratch fits the memory budget are sorted in memory and written as runs to
+// tempDir; runs are then merged with kWayMerge, each merge reading and writing through buffers that share
+// the budget. The fan-in drops until every buffer gets EXTERNAL_MIN_BUFFER bytes; only at a fan-in of 2
+// do the buffers shrink below that. On failure returns false with error set; temporary runs are removed
+// either way.
+inline bool externalSort(const string& inputPath, const string& outputPath, const ExternalSortConfig& config,
+                         ExternalSortStats& stats, string& error) {
+    using Clock = chrono::steady_clock;
+    stats = ExternalSortStats();
+    size_t budgetRecords = max<size_t>(1, config.memoryBudget / sizeof(Record));
+    size_t chunkRecords = max<size_t>(1, static_cast<size_t>(budgetRecords / (1 + max(0.0, config.runScratch))));
+    size_t affordableBuffers = config.memoryBudget / EXTERNAL_MIN_BUFFER; // fanIn readers plus one writer
+    size_t fanIn = max<size_t>(2, min(config.fanIn, affordableBuffers > 1 ? affordableBuffers - 1 : 0));
+    SortFunction runSort = config.runSort ? config.runSort : SortFunction([](vector<Record>& v) { TimSort(v); });
+
+    string tempPrefix = externalTempDir(config.tempDir) + "/extsort." + to_string(getpid()) + ".";
+    size_t tempCount = 0;
+    vector<string> runs;
+    auto fail = [&](const string& message) {
+        error = message + (errno ? string(": ") + strerror(errno) : "");
+        for (const string& run : runs) unlink(run.c_str());
+        return false;
+    };
+    errno = 0;
+
+    // Run formation
+    auto phaseStart = Clock::now();
+    int in = open(inputPath.c_str(), O_RDONLY);
+    if (in < 0) return fail("cannot read " + inputPath);
+    DatasetHeader header;
+    string headerError;
+    if (!readDatasetHeader(in, header, headerError)) {
+        close(in);
+        errno = 0;
+        return fail(inputPath + ": " + headerError);
+    }
+    posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+    size_t total = header.count;
+    DatasetHeader outputHeader = makeDatasetHeader(total, header.seed, datasetProvenance(header));
+
+    // Input that fits in one chunk is sorted straight into the output
+    bool singleRun = total <= chunkRecords;
+    vector<Record> chunk;
+    for (size_t done = 0; done < total || singleRun;) {
+        chunk.resize(min(chunkRecords, total - done));
+        if (readRecords(in, chunk.data(), chunk.size(), stats.runIo) != static_cast<ssize_t>(chunk.size())) {
+            close(in);
+            return fail("cannot read " + inputPath);
+        }
+        runSort(chunk);
+
+        string path = singleRun ? outputPath : tempPrefix + to_string(tempCount++);
+        if (!singleRun) runs.push_back(path);
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bool written = fd >= 0;
+        if (written && singleRun)
+            written = writeFully(fd, &outputHeader, sizeof(outputHeader)) == static_cast<ssize_t>(sizeof(outputHeader));
+        written = written && writeRecords(fd, chunk.data(), chunk.size(), stats.runIo);
+        if (fd >= 0) written = close(fd) == 0 && written;
+        if (!written) {
+            close(in);
+            return fail("cannot write " + path);
+        }
+        done += chunk.size();
+        if (singleRun) break;
+    }
+    close(in);
+    vector<Record>().swap(chunk);
+    stats.records = total;
+    stats.runs = singleRun ? 1 : runs.size();
+    stats.runPhaseTime = chrono::duration<double>(Clock::now() - phaseStart).count();
+
+    // Merge passes: groups of fanIn runs become one run each, until the last pass writes the output
+    phaseStart = Clock::now();
+    while (!runs.empty()) {
+        bool lastPass = runs.size() <= fanIn;
+        vector<string> merged;
+        // Hands this pass's finished runs to fail() too, so an error leaves no temp files behind
+        auto failMerge = [&](const string& message) {
+            runs.insert(runs.end(), merged.begin(), merged.end());
+            return fail(message);
+        };
+        for (size_t g = 0; g < runs.size(); g += fanIn) {
+            size_t groupSize = min(fanIn, runs.size() - g);
+            size_t overhead = (groupSize + 1) * EXTERNAL_BUFFER_OVERHEAD;
+            size_t bufferBytes = config.memoryBudget > overhead ? config.memoryBudget - overhead : 0;
+            size_t bufferRecords = max<size_t>(1, bufferBytes / sizeof(Record) / (groupSize + 1));
+
+            vector<unique_ptr<RecordReader>> readers;
+            vector<pair<RecordReader::Cursor, RecordReader::Cursor>> cursors;
+            for (size_t r = g; r < g + groupSize; ++r) {
+                readers.push_back(make_unique<RecordReader>(bufferRecords, stats.mergeIo));
+                if (!readers.back()->open(runs[r])) return failMerge("cannot read run " + runs[r]);
+                cursors.emplace_back(readers.back()->begin(), readers.back()->end());
+            }
+
+            string path = lastPass ? outputPath : tempPrefix + to_string(tempCount++);
+            RecordWriter writer(bufferRecords, stats.mergeIo);
+            if (!writer.open(path, lastPass ? &outputHeader : nullptr)) return failMerge("cannot write " + path);
+            if (!lastPass) merged.push_back(path);
+            kWayMerge(cursors, writer.inserter());
+
+            bool readOk = all_of(readers.begin(), readers.end(), [](const auto& r) { return r->ok(); });
+            if (!writer.close() || !readOk) return failMerge("merge into " + path + " failed");
+            for (size_t r = g; r < g + groupSize; ++r) unlink(runs[r].c_str());
+        }
+        runs = merged;
+        ++stats.mergePasses;
+    }
+    stats.mergePhaseTime = chrono::duration<double>(Clock::now() - phaseStart).count();
+    return true;
+}
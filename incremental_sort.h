@@ -0,0 +1,120 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "advanced_sorts.h"
+#include "basic_sorts.h"
+#include "sort_traits.h"
+
+using namespace std;
+
+// ------------------------------
+// Sorted Run Log (Incremental, Stable)
+// ------------------------------
+// Holds every record appended so far, ready to be read in key order at any time without a re-sort. Each
+// appended batch is Tim sorted on its own (presorted batches cost one scan) and becomes a new run at the
+// end of one contiguous array. Runs are then merged TimSort-style: while the run before the last is not
+// more than RUN_LOG_MERGE_RATIO times longer than the last, the two are merged. Run lengths therefore
+// shrink geometrically toward the end, so there are O(log n) runs and a record is merged O(log n) times
+// over its life. Reads binary-search every run and merge the matching slices with the loser tree.
+// Equal keys come out in append order.
+const size_t RUN_LOG_MERGE_RATIO = 2;
+
+template <typename T, typename KeyFn = FirstKey, typename Compare = less<>>
+class SortedRunLog {
+public:
+    using Key = decay_t<decltype(declval<KeyFn>()(declval<const T&>()))>;
+
+    explicit SortedRunLog(KeyFn key = {}, Compare comp = {}) : key(key), comp(comp) {}
+
+    // Appends an unsorted batch
+    template <typename InputIt>
+    void append(InputIt first, InputIt last) {
+        size_t base = records.size();
+        records.insert(records.end(), first, last);
+        if (records.size() == base) return;
+        TimSort(records.begin() + base, records.end(), key, comp);
+        runStarts.push_back(base);
+
+        while (runStarts.size() > 1 && runLength(runStarts.size() - 2) <= RUN_LOG_MERGE_RATIO * runLength(runStarts.size() - 1))
+            mergeLastRuns();
+    }
+
+    // Merges all runs into one, after which reads are a single binary search
+    void compact() {
+        while (runStarts.size() > 1) mergeLastRuns();
+    }
+
+    // Writes every record to out in key order
+    template <typename OutIt>
+    OutIt sorted(OutIt out) const {
+        return mergeSlices(out, [](auto first, auto) { return first; }, [](auto, auto last) { return last; });
+    }
+
+    // Writes the records with lo <= key < hi to out in key order
+    template <typename OutIt>
+    OutIt range(const Key& lo, const Key& hi, OutIt out) const {
+        return mergeSlices(out, [&](auto first, auto last) { return lowerBound(first, last, lo); },
+                           [&](auto first, auto last) { return lowerBound(first, last, hi); });
+    }
+
+    // Number of records with lo <= key < hi
+    size_t count(const Key& lo, const Key& hi) const {
+        size_t total = 0;
+        for (size_t r = 0; r < runStarts.size(); ++r)
+            total += lowerBound(runBegin(r), runEnd(r), hi) - lowerBound(runBegin(r), runEnd(r), lo);
+        return total;
+    }
+
+    size_t size() const { return records.size(); }
+    size_t runCount() const { return runStarts.size(); }
+
+private:
+    using ConstIt = typename vector<T>::const_iterator;
+
+    size_t runLength(size_t r) const { return (r + 1 < runStarts.size() ? runStarts[r + 1] : records.size()) - runStarts[r]; }
+    ConstIt runBegin(size_t r) const { return records.begin() + runStarts[r]; }
+    ConstIt runEnd(size_t r) const { return runBegin(r) + runLength(r); }
+
+    ConstIt lowerBound(ConstIt first, ConstIt last, const Key& k) const {
+        return lower_bound(first, last, k, [&](const T& rec, const Key& v) { return comp(key(rec), v); });
+    }
+
+    // Stable merge of the last two runs through the scratch buffer
+    void mergeLastRuns() {
+        size_t base = runStarts[runStarts.size() - 2];
+        ptrdiff_t mid = runStarts.back() - base, n = records.size() - base;
+        auto lt = makeKeyLess(key, comp);
+
+        // Runs already in order (e.g. an in-order stream) just join
+        if (lt(records[base + mid], records[base + mid - 1])) {
+            scratch.resize(n);
+            mergeRunsInto(records.begin() + base, mid, n, scratch.begin(), lt);
+            move(scratch.begin(), scratch.end(), records.begin() + base);
+        }
+        runStarts.pop_back();
+    }
+
+    // Merges the slice [sliceBegin, sliceEnd) of every run into out, older runs first among equal keys
+    template <typename OutIt, typename BeginOf, typename EndOf>
+    OutIt mergeSlices(OutIt out, BeginOf sliceBegin, EndOf sliceEnd) const {
+        vector<pair<ConstIt, ConstIt>> slices;
+        for (size_t r = 0; r < runStarts.size(); ++r) {
+            ConstIt first = sliceBegin(runBegin(r), runEnd(r));
+            ConstIt last = sliceEnd(runBegin(r), runEnd(r));
+            if (first != last) slices.emplace_back(first, last);
+        }
+        if (slices.empty()) return out;
+        if (slices.size() == 1) return copy(slices[0].first, slices[0].second, out);
+        return kWayMerge(slices, out, key, comp);
+    }
+
+    KeyFn key;
+    Compare comp;
+    vector<T> records;        // The runs, back to back
+    vector<size_t> runStarts; // Offset of each run in records
+    vector<T> scratch;        // Merge buffer, kept between merges
+};
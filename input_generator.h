@@ -1,62 +1,212 @@
 #pragma once
 #include <vector>
 #include <algorithm>
-#include <random>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <iostream>
-#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "thread_pool.h"
+
 using namespace std;
 
+// ------------------------------
+// Seeded Random Streams
+// ------------------------------
+inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Counter-based stream: draw i of stream `seed` depends only on (seed, i), so any chunk of an input
+// can be generated on any thread, in any order, and the result is identical for a given seed
+inline uint64_t randomAt(uint64_t seed, uint64_t i) {
+    return splitmix64(splitmix64(seed) + i * 0x9e3779b97f4a7c15ULL);
+}
+
+// Uniform double in [0, 1) from the same stream
+inline double uniformAt(uint64_t seed, uint64_t i) {
+    return (randomAt(seed, i) >> 11) * 0x1.0p-53;
+}
 
+// ------------------------------
+// Input Distributions
+// ------------------------------
 // Returns a modulo value to control duplicate frequency
-int getDuplicateMod(int size) {
+inline int getDuplicateMod(size_t size) {
     if (size <= 1000) return 100;
     else if (size <= 10000) return 500;
     else if (size <= 100000) return 2000;
     else return 10000;
 }
 
-// Generate sorted data (ascending, with duplicates)
-vector<int> generateSorted(int size) {
-    vector<int> data(size);
-    for (int i = 0; i < size; ++i) data[i] = i % getDuplicateMod(size);
-    sort(data.begin(), data.end());
-    return data;
-}
+// Value of element i, fixed once the generator is made; must not depend on other elements
+using PositionGenerator = function<int(size_t i)>;
 
-// Generate reverse sorted data (descending, with duplicates)
-vector<int> generateReverseSorted(int size) {
-    vector<int> data(size);
-    for (int i = 0; i < size; ++i) data[i] = i % getDuplicateMod(size);
-    sort(data.rbegin(), data.rend());
-    return data;
+struct InputDistribution {
+    string name;
+    string param; // Meaning of the optional "Name:param" value, empty if the shape has none
+    function<PositionGenerator(size_t n, double param, uint64_t seed)> make;
+
+    // Optional serial pass after the parallel fill, for shapes defined by edits (e.g. swaps)
+    function<void(pair<int, int>* data, size_t n, double param, uint64_t seed)> finish;
+};
+
+// A distribution plus its parameter, parsed from "Name" or "Name:param"; param is NaN for the default
+struct InputSpec {
+    const InputDistribution* dist = nullptr;
+    double param = NAN;
+};
+
+inline double paramOr(double param, double fallback) { return isnan(param) ? fallback : param; }
+
+inline const vector<InputDistribution>& inputDistributions() {
+    static const vector<InputDistribution> dists = {
+        // The four original shapes draw from 0..getDuplicateMod(n)-1. Sorted and ReverseSorted hold n / mod
+        // copies of each value; Random and the tail of PartiallySorted draw each value independently, so
+        // the copies per value vary around n / mod
+        {"Sorted", "", [](size_t n, double, uint64_t) -> PositionGenerator {
+            int mod = getDuplicateMod(n);
+            return [=](size_t i) { return static_cast<int>(i * mod / n); };
+        }, nullptr},
+        {"ReverseSorted", "", [](size_t n, double, uint64_t) -> PositionGenerator {
+            int mod = getDuplicateMod(n);
+            return [=](size_t i) { return mod - 1 - static_cast<int>(i * mod / n); };
+        }, nullptr},
+        {"Random", "", [](size_t n, double, uint64_t seed) -> PositionGenerator {
+            int mod = getDuplicateMod(n);
+            return [=](size_t i) { return static_cast<int>(randomAt(seed, i) % mod); };
+        }, nullptr},
+        // A cyclic 0..mod-1 prefix followed by random values
+        {"PartiallySorted", "ordered fraction (0.7)", [](size_t n, double param, uint64_t seed) -> PositionGenerator {
+            int mod = getDuplicateMod(n);
+            size_t orderedSize = static_cast<size_t>(n * paramOr(param, 0.7));
+            return [=](size_t i) {
+                return static_cast<int>(i < orderedSize ? i % mod : randomAt(seed, i) % mod);
+            };
+        }, nullptr},
+
+        // Rank r (0-based) drawn with probability proportional to 1 / (r + 1)^s over min(n, 2^20) ranks
+        {"Zipf", "exponent s (1.0)", [](size_t n, double param, uint64_t seed) -> PositionGenerator {
+            double s = paramOr(param, 1.0);
+            size_t ranks = min<size_t>(max<size_t>(n, 1), 1 << 20);
+            auto cdf = make_shared<vector<double>>(ranks);
+            double total = 0;
+            for (size_t r = 0; r < ranks; ++r) (*cdf)[r] = total += pow(static_cast<double>(r + 1), -s);
+            for (double& c : *cdf) c /= total;
+
+            // Guide table: first rank of each of G equal slices of [0, 1), so a draw only searches its slice
+            const size_t G = 1 << 16;
+            auto guide = make_shared<vector<uint32_t>>(G + 1);
+            for (size_t b = 0; b <= G; ++b)
+                (*guide)[b] = static_cast<uint32_t>(lower_bound(cdf->begin(), cdf->end(), double(b) / G) - cdf->begin());
+            return [=](size_t i) {
+                double u = uniformAt(seed, i);
+                size_t b = static_cast<size_t>(u * G);
+                auto lo = cdf->begin() + (*guide)[b];
+                auto hi = cdf->begin() + min<size_t>(ranks, (*guide)[b + 1] + 1);
+                size_t rank = upper_bound(lo, hi, u) - cdf->begin();
+                return static_cast<int>(min(rank, ranks - 1));
+            };
+        }, nullptr},
+        {"FewUnique", "distinct values (16)", [](size_t, double param, uint64_t seed) -> PositionGenerator {
+            uint64_t distinct = max<uint64_t>(1, static_cast<uint64_t>(paramOr(param, 16)));
+            int spacing = static_cast<int>(INT32_MAX / distinct);
+            return [=](size_t i) { return static_cast<int>(randomAt(seed, i) % distinct) * spacing; };
+        }, nullptr},
+        // 0, 1, ..., n/2, ..., 1, 0
+        {"OrganPipe", "", [](size_t n, double, uint64_t) -> PositionGenerator {
+            return [=](size_t i) { return static_cast<int>(min(i, n - 1 - i)); };
+        }, nullptr},
+        // Ascending teeth of equal length
+        {"Sawtooth", "teeth (16)", [](size_t n, double param, uint64_t) -> PositionGenerator {
+            size_t teeth = max<size_t>(1, static_cast<size_t>(paramOr(param, 16)));
+            size_t period = max<size_t>(1, (n + teeth - 1) / teeth);
+            return [=](size_t i) { return static_cast<int>(i % period); };
+        }, nullptr},
+        // 0..n-1 with k random pairs swapped afterwards
+        {"NearlySorted", "swaps k (n / 1000)", [](size_t, double, uint64_t) -> PositionGenerator {
+            return [](size_t i) { return static_cast<int>(i); };
+        }, [](pair<int, int>* data, size_t n, double param, uint64_t seed) {
+            if (n < 2) return;
+            size_t swaps = static_cast<size_t>(paramOr(param, max<size_t>(1, n / 1000)));
+            uint64_t stream = splitmix64(seed ^ 0x5eed5eedULL);
+            for (size_t k = 0; k < swaps; ++k) {
+                size_t a = randomAt(stream, 2 * k) % n, b = randomAt(stream, 2 * k + 1) % n;
+                swap(data[a].first, data[b].first);
+            }
+        }},
+        // Ascending runs of length r, each starting at a random offset in [0, n - r] so values stay below n
+        {"SortedRuns", "run length r (sqrt n)", [](size_t n, double param, uint64_t seed) -> PositionGenerator {
+            size_t r = max<size_t>(1, static_cast<size_t>(paramOr(param, sqrt(static_cast<double>(n)))));
+            r = min(r, max<size_t>(1, n));
+            size_t starts = max<size_t>(1, n - r + 1);
+            return [=](size_t i) {
+                size_t value = randomAt(seed, i / r) % starts + i % r;
+                return static_cast<int>(value);
+            };
+        }, nullptr},
+        {"AllEqual", "", [](size_t, double, uint64_t) -> PositionGenerator {
+            return [](size_t) { return 42; };
+        }, nullptr},
+        // Musser's median-of-3 killer: with n = 2k, a[i] = i for odd i, a[i] = k + i - 1 for even i (1-based,
+        // i <= k), then a[k + i] = 2i. Drives median-of-three quicksort towards quadratic partitions.
+        {"MedianOf3Killer", "", [](size_t n, double, uint64_t) -> PositionGenerator {
+            size_t k = n / 2;
+            return [=](size_t idx) {
+                size_t i = idx + 1;
+                if (i > 2 * k) return static_cast<int>(n); // Odd n: largest value last
+                if (i <= k) return static_cast<int>(i % 2 ? i : k + i - 1);
+                return static_cast<int>(2 * (i - k));
+            };
+        }, nullptr},
+    };
+    return dists;
 }
 
-// Generate completely random data (with duplicates)
-vector<int> generateRandom(int size) {
-    vector<int> data(size);
-    for (int i = 0; i < size; ++i) data[i] = i % getDuplicateMod(size);
-    unsigned seed = chrono::system_clock::now().time_since_epoch().count();
-    shuffle(data.begin(), data.end(), default_random_engine(seed));
-    return data;
+// Parses "Name" or "Name:param"; dist stays null if the name is unknown or the param malformed
+inline InputSpec findInputDistribution(const string& spec) {
+    InputSpec result;
+    size_t colon = spec.find(':');
+    string name = spec.substr(0, colon);
+    if (colon != string::npos) {
+        char* end = nullptr;
+        string value = spec.substr(colon + 1);
+        result.param = strtod(value.c_str(), &end);
+        if (value.empty() || *end != '\0' || result.param < 0) return {};
+    }
+    for (const auto& dist : inputDistributions())
+        if (dist.name == name) result.dist = &dist;
+    return result;
 }
 
-// Generate partially sorted data (with duplicates)
-vector<int> generatePartiallySorted(int size, double sortedRatio = 0.7) {
-    int sortedSize = size * sortedRatio;
-    vector<int> data(size);
-    for (int i = 0; i < sortedSize; ++i) data[i] = i % getDuplicateMod(size);;
+const size_t INPUT_GENERATION_GRAIN = 1 << 16; // Elements per parallel generation chunk
 
-    unsigned seed = chrono::system_clock::now().time_since_epoch().count();
-    default_random_engine rng(seed);
-    for (int i = sortedSize; i < size; ++i)
-        data[i] = rng() % getDuplicateMod(size);
+// Writes the n (value, original index) records of an input to data, in parallel chunks
+inline void fillRecords(const InputSpec& spec, pair<int, int>* data, size_t n, uint64_t seed) {
+    PositionGenerator valueAt = spec.dist->make(n, spec.param, seed);
+    size_t chunks = (n + INPUT_GENERATION_GRAIN - 1) / INPUT_GENERATION_GRAIN;
+    parallelFor(chunks, [&](size_t c) {
+        size_t end = min(n, (c + 1) * INPUT_GENERATION_GRAIN);
+        for (size_t i = c * INPUT_GENERATION_GRAIN; i < end; ++i)
+            data[i] = {valueAt(i), static_cast<int>(i)};
+    });
+    if (spec.dist->finish) spec.dist->finish(data, n, spec.param, seed);
+}
 
+inline vector<pair<int, int>> generateRecords(const InputSpec& spec, size_t n, uint64_t seed) {
+    vector<pair<int, int>> data(n);
+    fillRecords(spec, data.data(), n, seed);
     return data;
 }
 
-
 // Utility: print first few values (for testing)
-void printPreview(const vector<int>& data, int limit = 10) {
+inline void printPreview(const vector<int>& data, int limit = 10) {
     for (int i = 0; i < min((int)data.size(), limit); ++i) {
         cout << data[i] << " ";
     }
@@ -1,93 +1,309 @@
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
-#include <ctime>
-#include <unordered_set>
+#include <new>
+#include <malloc.h>
+#include <climits>
+#include <cmath>
+#include <map>
 #include <sys/resource.h>
 
+#include "alloc_counter.h"
+#include "cli.h"
+#include "dataset_file.h"
 #include "input_generator.h"
+#include "perf_counters.h"
 #include "test.h"
 #include "basic_sorts.h"
 #include "advanced_sorts.h"
+#include "parallel_sorts.h"
+#include "radix_sorts.h"
+#include "adaptive_sorts.h"
 
 using namespace std;
 
-// Global CSV output stream
-ofstream csvOut("results.csv");
+// Route every heap allocation through the counters in alloc_counter.h so the harness can report
+// allocations, bytes and peak heap per sort. Sizes are malloc's usable sizes, so frees balance exactly.
+// Kept out of line: once inlined, GCC sees malloc/free behind new/delete and flags them as mismatched.
+__attribute__((noinline)) void* operator new(size_t size) {
+    if (void* p = malloc(size ? size : 1)) {
+        recordAllocation(malloc_usable_size(p));
+        return p;
+    }
+    throw bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    if (!p) return;
+    recordDeallocation(malloc_usable_size(p));
+    free(p);
+}
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { operator delete(p); }
 
-// Wrapper functions (used instead of lambdas for stable function pointers)
-void MergeSortWrapper(vector<pair<int, int>>& arr) { MergeSort(arr, 0, arr.size() - 1); }
-void QuickSortWrapper(vector<pair<int, int>>& arr) { QuickSort(arr, 0, arr.size() - 1); }
-void IntroSortWrapper(vector<pair<int, int>>& arr) { IntroSort(arr); }
-void TimSortWrapper(vector<pair<int, int>>& arr) { TimSort(arr); }
+int main(int argc, char** argv) {
+    RunOptions options;
+    string error;
+    if (!parseRunOptions(argc, argv, options, error)) {
+        cerr << "Error: " << error << "\n\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (options.help) {
+        printUsage(argv[0]);
+        return 0;
+    }
 
-int main() {
-    srand(time(0)); // Seed RNG
-    csvOut << "Algorithm,Size,InputType,Time,Memory,ActualMemoryKB,InversionBefore,InversionAfter,SortStatus,Stability,StablePercent\n";
+    // Sorts register themselves from their headers; --algorithms narrows the set
+    vector<SortEntry> sorts = selectSorts(options);
+    if (options.list) {
+        for (const auto& entry : sortRegistry())
+            cout << entry.name << (entry.quadratic ? " (quadratic)" : "") << "\n";
+        return 0;
+    }
+    // The comparison modes filter their own engines, which need not be registered sorts
+    bool engineMode = !options.layoutRecordBytes.empty() || !options.smallArrayLengths.empty()
+                   || !options.topK.empty() || !options.ingestBatches.empty() || !options.tunePath.empty();
+    if (sorts.empty() && !engineMode) {
+        cerr << "Error: no registered sort matches --algorithms\n";
+        return 1;
+    }
 
-    vector<int> sizes = {1000, 10000, 100000, 1000000};
-    vector<string> inputTypes = {"Sorted", "ReverseSorted", "Random", "PartiallySorted"};
+    if (options.threads > 0) setParallelSortThreads(options.threads);
+    setHeapArity(options.heapArity);
 
-    // Algorithms considered too slow for large input sizes
-    unordered_set<string> slowAlgorithms = {
-        "Bubble Sort", "Insertion Sort", "Selection Sort",
-        "Cocktail Shaker Sort", "Comb Sort"
-    };
+    // Auto Sort thresholds from an earlier --tune, in place of the built-in ones
+    if (!options.autoProfilePath.empty() && !loadAutoSortProfile(options.autoProfilePath, autoSortProfile(), error)) {
+        cerr << "Error: " << error << "\n";
+        return 1;
+    }
 
-    // List of sorting functions to test
-    vector<pair<string, function<void(vector<pair<int, int>>&)>>> sortFuncs = {
-        {"Bubble Sort", BubbleSort},
-        {"Insertion Sort", InsertionSort},
-        {"Selection Sort", SelectionSort},
-        {"Cocktail Shaker Sort", CocktailShakerSort},
-        {"Comb Sort", CombSort},
-        {"Merge Sort", MergeSortWrapper},
-        {"Quick Sort", QuickSortWrapper},
-        {"Heap Sort", HeapSort},
-        {"Tournament Sort", TournamentSort},
-        {"Library Sort", LibrarySort},
-        {"Tim Sort", TimSortWrapper},
-        {"Intro Sort", IntroSortWrapper},
-    };
+    // Dataset generation mode: records go straight into the mapped files, nothing is sorted
+    if (!options.datasetDir.empty()) {
+        for (int size : options.sizes) {
+            for (const auto& type : options.inputTypes) {
+                string path = options.datasetDir + "/" + type + "-" + to_string(size) + "-s" + to_string(options.seed)
+                            + ".sortdata";
+                if (!generateDataset(path, type, size, options.seed, error)) {
+                    cerr << "Error: " << error << "\n";
+                    return 1;
+                }
+                cout << path << "\n";
+            }
+        }
+        return 0;
+    }
+
+    // Leaf kernels run at the requested level, capped at what the CPU supports
+    setSimdLevel(options.simd);
+    setSimdMerge(options.simdMerge);
+    if (simdLevel() != options.simd)
+        cout << "--simd=" << simdLevelName(options.simd) << " is not supported here; using " << simdLevelName(simdLevel()) << "\n";
+
+    // Pin the harness (and the pool workers after it) so runs don't migrate between CPUs
+    setParallelSortPinning(benchmarkConfig().pinCpu);
+
+    // Optional hardware counters (cycles, cache and TLB misses, ...); columns read "-" when off or unsupported.
+    // They open before the first parallel sort or input starts the pool, so the workers inherit them.
+    setPerfCountersEnabled(options.counters);
+    if (perfCountersEnabled() && !harnessPerfCounters().any()) {
+        cout << "--counters given, but perf_event_open is unavailable on this host; counters are skipped\n";
+        setPerfCountersEnabled(false);
+    }
+
+    setInversionAnalysisEnabled(options.inversions);
+
+    // Tuning mode: time Auto Sort's engines over the sizes and input types and save the thresholds they favour
+    if (!options.tunePath.empty()) {
+        AutoSortProfile profile = autoSortProfile();
+        if (!tuneAutoSort(options.sizes, options.inputTypes, options.seed, profile, error)
+            || !saveAutoSortProfile(options.tunePath, profile, error)) {
+            cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        cout << "Wrote " << options.tunePath << "\n";
+        return 0;
+    }
+
+    if (!resultWriter().open(options.outputPath, options.format)) {
+        cerr << "Error: cannot write " << options.outputPath << "\n";
+        return 1;
+    }
+
+    // Parallel engines and the serial sorts their speedup is reported against
+    vector<string> parallelAlgorithms = {"Parallel Merge Sort", "Parallel Sample Sort"};
+    vector<string> serialBaselines = {"Merge Sort", "Intro Sort"};
 
     // Stability test using duplicate-rich input
     const int STABILITY_TEST_SIZE = 1000;
-    for (const auto& [name, func] : sortFuncs) {
-        auto freshInput = generateDuplicateRichInput(STABILITY_TEST_SIZE);
-        runStabilityTest(name, func, freshInput);
+    if (options.stability) {
+        for (const auto& entry : sorts) {
+            auto freshInput = generateDuplicateRichInput(STABILITY_TEST_SIZE, options.seed);
+            runStabilityTest(entry.name, entry.func, freshInput, options.seed);
+        }
     }
 
-    // Run experiments for each input type and size
-    for (int size : sizes) {
-        cout << "\n==============================\n";
-        cout << "Running experiments on size: " << size << "\n";
+    // (size, median time) of each (sort, input type) at the last size it ran, for the time budget
+    map<pair<string, string>, pair<size_t, double>> lastCell;
 
-        for (const auto& type : inputTypes) {
-            cout << "\n-- Input Type: " << type << " --\n";
+    // The external sort streams dataset files and never needs their records in memory; the comparison
+    // modes and the in-memory sorts do
+    bool inMemory = !options.external || engineMode;
+
+    // One cell: every selected sort on one input. Dataset inputs pass their file, which the external
+    // mode sorts directly, and their mapping, which sorts with a range entry point sort in place; input
+    // then only holds a copy if some engine needs one. Generated inputs are written to a temporary dataset first.
+    auto runCell = [&](size_t size, const string& type, uint64_t seed, const vector<pair<int, int>>& input,
+                       const MultisetHash& inputHash, const string& datasetPath, MappedDataset* mapped) {
+        // Layout mode replaces the registered sorts with the AoS vs SoA comparison
+        if (!options.layoutRecordBytes.empty()) {
+            for (const string& engine : layoutEngines()) {
+                if (!algorithmSelected(options, engine)) continue;
+                for (size_t bytes : options.layoutRecordBytes) runLayoutComparison(engine, bytes, input, type, size, seed);
+            }
+            return;
+        }
+
+        // Small-array mode: the input becomes a batch of independent arrays for the small-range engines
+        if (!options.smallArrayLengths.empty()) {
+            for (size_t length : options.smallArrayLengths) {
+                for (const auto& engine : smallArrayEngines())
+                    if (algorithmSelected(options, engine.first))
+                        runSmallArrayBatch(engine.first, engine.second, length, input, type, size, seed);
+            }
+            return;
+        }
+
+        // Selection mode: each k is answered by the selection engines and by a full sort plus slicing
+        if (!options.topK.empty()) {
+            for (size_t k : options.topK) {
+                map<string, double> times;
+                for (const string& engine : selectionEngines())
+                    if (algorithmSelected(options, engine))
+                        times[engine] = runSelectionExperiment(engine, k, input, type, size, seed);
+                cout << "\n";
+                const auto& engines = selectionEngines();
+                reportSpeedup(times, vector<string>(engines.begin() + 1, engines.end()), {engines.front()});
+            }
+            return;
+        }
 
-            vector<int> raw;
-            if (type == "Sorted") raw = generateSorted(size);
-            else if (type == "ReverseSorted") raw = generateReverseSorted(size);
-            else if (type == "Random") raw = generateRandom(size);
-            else if (type == "PartiallySorted") raw = generatePartiallySorted(size);
+        // Ingest mode: the input arrives in batches, and the run log is measured against re-sorting
+        if (!options.ingestBatches.empty()) {
+            for (size_t batch : options.ingestBatches) {
+                map<string, double> times;
+                for (const string& engine : ingestEngines())
+                    if (algorithmSelected(options, engine))
+                        times[engine] = runIngestExperiment(engine, batch, input, type, size, seed);
+                cout << "\n";
+                const auto& engines = ingestEngines();
+                reportSpeedup(times, {engines.back()}, vector<string>(engines.begin(), engines.end() - 1));
+            }
+            return;
+        }
 
-            // Convert to (value, original index) pairs
-            vector<pair<int, int>> input(raw.size());
-            for (int i = 0; i < raw.size(); ++i) {
-                input[i] = {raw[i], i};
+        string inputPath = datasetPath;
+        if (options.external && inputPath.empty()) {
+            inputPath = externalTempDir(options.externalConfig.tempDir) + "/extsort." + to_string(getpid()) + ".input";
+            if (!writeDataset(inputPath, input.data(), input.size(), seed, type, error)) {
+                cout << "Error: " << error << "\n";
+                return;
             }
+        }
 
-            // Run selected experiment depending on algorithm speed and input size
-            for (const auto& [name, sortFunc] : sortFuncs) {
-                if (slowAlgorithms.count(name) && size > 10000) {
-                    runSingleExperiment(name, sortFunc, input, type, size);
-                } else {
-                    runExperiment(name, sortFunc, input, type, size);
+        map<string, double> times;
+        for (const auto& entry : sorts) {
+            // A running sort can't be interrupted, so runaway cells are skipped up front: extrapolate
+            // from the previous size (n^2 for quadratic sorts, n log n otherwise)
+            auto last = lastCell.find({entry.name, type});
+            if (options.cellBudget > 0 && last != lastCell.end()) {
+                double ratio = static_cast<double>(size) / last->second.first;
+                double growth = entry.quadratic
+                    ? ratio * ratio
+                    : ratio * log2(max<size_t>(size, 2)) / log2(max<size_t>(last->second.first, 2));
+                double predicted = last->second.second * growth;
+                if (predicted > options.cellBudget) {
+                    cout << "\n[" << entry.name << "]\nSkipped: predicted " << predicted << " sec exceeds the "
+                         << options.cellBudget << " sec budget\n";
+                    ResultRow row;
+                    row.set("Algorithm", entry.name);
+                    row.set("Size", size);
+                    row.set("InputType", type);
+                    row.set("Seed", seed);
+                    row.set("SortStatus", "Skipped");
+                    resultWriter().write(row);
+                    continue;
                 }
             }
+
+            if (options.external)
+                times[entry.name] = runExternalExperiment(entry, inputPath, inputHash, type, size, seed,
+                                                          options.externalConfig);
+            else if (mapped && entry.range)
+                times[entry.name] = runExperimentInPlace(entry.name, entry.range, *mapped, inputHash, type, size, seed);
+            else
+                times[entry.name] = runExperiment(entry.name, entry.func, input, type, size, seed);
+            lastCell[{entry.name, type}] = {size, times[entry.name]};
+        }
+        if (inputPath != datasetPath) unlink(inputPath.c_str());
+
+        cout << "\n";
+        reportSpeedup(times, parallelAlgorithms, serialBaselines);
+
+        // Which path Adaptive Sort took on this input, and what it saved over the fallback
+        if (times.count("Adaptive Sort")) {
+            const auto& adaptive = lastAdaptiveSortReport();
+            cout << "Adaptive Sort path: " << adaptive.path << " (key range " << adaptive.profile.range
+                 << ", ~" << adaptive.profile.distinctEstimate << " distinct keys)\n";
+            reportSpeedup(times, {"Adaptive Sort"}, {"Tim Sort", "Intro Sort"});
+        }
+
+        // What the Auto Sort probe saw and which engine it picked
+        if (times.count("Auto Sort")) {
+            const auto& chosen = lastAutoSortReport();
+            const InputShape& shape = chosen.shape;
+            cout << "Auto Sort path: " << chosen.path << " (descents " << shape.descentRate << ", ascents "
+                 << shape.ascentRate << ", inversions " << shape.inversionRatio << ", range/n " << shape.rangeRatio
+                 << ", repeats " << shape.duplicateRatio << ")\n";
+            reportSpeedup(times, {"Auto Sort"}, {"Tim Sort", "Intro Sort"});
+        }
+    };
+
+    // Dataset files replace the generated sizes and input types; the mapping costs page faults, not a parse
+    for (const string& path : options.datasets) {
+        MappedDataset dataset;
+        if (!dataset.open(path, error)) {
+            cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        if (inMemory && dataset.size() > static_cast<size_t>(INT_MAX)) {
+            cerr << "Error: " << path << " holds more records than the in-memory sorts index\n";
+            return 1;
+        }
+        string type = datasetProvenance(dataset.header());
+        if (type.empty()) type = path;
+        cout << "\n==============================\n";
+        cout << "Running experiments on dataset: " << path << " (" << dataset.size() << " records, " << type << ")\n";
+        dataset.adviseSequential();
+        MultisetHash inputHash = multisetHash(dataset.begin(), dataset.end());
+        vector<pair<int, int>> input;
+        if (inMemory && (engineMode || any_of(sorts.begin(), sorts.end(), [](const SortEntry& e) { return !e.range; })))
+            input.assign(dataset.begin(), dataset.end());
+        runCell(dataset.size(), type, dataset.header().seed, input, inputHash, path, &dataset);
+    }
+
+    // Run experiments for each input type and size
+    for (int size : options.datasets.empty() ? options.sizes : vector<int>()) {
+        cout << "\n==============================\n";
+        cout << "Running experiments on size: " << size << "\n";
+
+        for (const auto& type : options.inputTypes) {
+            cout << "\n-- Input Type: " << type << " --\n";
+
+            // (value, original index) records, the same for every run with this seed
+            vector<pair<int, int>> input = generateRecords(findInputDistribution(type), size, options.seed);
+            runCell(size, type, options.seed, input, multisetHash(input), "", nullptr);
         }
     }
 
-    csvOut.close();
+    resultWriter().close();
     return 0;
 }
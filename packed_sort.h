@@ -0,0 +1,117 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "advanced_sorts.h"
+#include "parallel_sorts.h"
+#include "radix_sorts.h"
+#include "simd_sort.h"
+#include "sort_registry.h"
+
+using namespace std;
+
+// ------------------------------
+// Packed Key + Index Records
+// ------------------------------
+// One 64-bit word per record: the key, sign bit flipped, in the high half and the index in the low half.
+// A single unsigned compare orders by key and then by index, so every engine is stable on this layout,
+// and the sort moves 8-byte words no matter how large the payload the index points at.
+using PackedRecord = uint64_t;
+
+inline PackedRecord packRecord(int key, uint32_t index) {
+    return (static_cast<uint64_t>(radixOrderedKey(key)) << 32) | index;
+}
+
+inline int packedKey(PackedRecord w) { return static_cast<int>(static_cast<uint32_t>(w >> 32) ^ 0x80000000u); }
+inline uint32_t packedIndex(PackedRecord w) { return static_cast<uint32_t>(w); }
+
+// Radix key of a packed word: the order-mapped key alone, so an LSD pass count depends on the key range only
+struct PackedRadixKey {
+    uint32_t operator()(PackedRecord w) const { return static_cast<uint32_t>(w >> 32); }
+};
+
+// (value, original index) records to packed words and back; .second must be a non-negative index
+inline void packRecords(const vector<pair<int, int>>& records, vector<PackedRecord>& words) {
+    words.resize(records.size());
+    for (size_t i = 0; i < records.size(); ++i)
+        words[i] = packRecord(records[i].first, static_cast<uint32_t>(records[i].second));
+}
+
+inline void unpackRecords(const vector<PackedRecord>& words, vector<pair<int, int>>& records) {
+    records.resize(words.size());
+    for (size_t i = 0; i < words.size(); ++i)
+        records[i] = {packedKey(words[i]), static_cast<int>(packedIndex(words[i]))};
+}
+
+// ------------------------------
+// Permutation Apply
+// ------------------------------
+const size_t PERMUTATION_PREFETCH_DISTANCE = 16; // Words ahead whose payload is prefetched
+
+// Reorders payload into the order of sorted packed words: out[i] = payload[index of sorted[i]].
+// A gather into a new buffer moves each payload exactly once; writes are sequential and the
+// random reads are prefetched a few records ahead, which is what large payloads are bound by.
+template <typename T>
+void applyPermutation(vector<T>& payload, const vector<PackedRecord>& sorted) {
+    size_t n = sorted.size();
+    vector<T> out(n);
+    const size_t grain = 1 << 14;
+    parallelFor((n + grain - 1) / grain, [&](size_t c) {
+        size_t end = min(n, (c + 1) * grain);
+        for (size_t i = c * grain; i < end; ++i) {
+            if (i + PERMUTATION_PREFETCH_DISTANCE < end)
+                __builtin_prefetch(&payload[packedIndex(sorted[i + PERMUTATION_PREFETCH_DISTANCE])]);
+            out[i] = std::move(payload[packedIndex(sorted[i])]);
+        }
+    });
+    payload.swap(out);
+}
+
+// ------------------------------
+// Packed Sort Path
+// ------------------------------
+// Sorts records through the packed layout: pack, sort the words with sortWords, unpack
+template <typename WordSort>
+void sortPacked(vector<pair<int, int>>& arr, WordSort sortWords) {
+    vector<PackedRecord> words;
+    packRecords(arr, words);
+    sortWords(words);
+    unpackRecords(words, arr);
+}
+
+inline void PackedIntroSort(vector<pair<int, int>>& arr) {
+    sortPacked(arr, [](vector<PackedRecord>& w) { IntroSort(w.begin(), w.end(), IdentityKey{}); });
+}
+REGISTER_SORT(PackedIntroSort, "Intro Sort (Packed)", 1, PackedIntroSort);
+
+inline void PackedLSDRadixSort(vector<pair<int, int>>& arr) {
+    sortPacked(arr, [](vector<PackedRecord>& w) { LSDRadixSort(w.begin(), w.end(), PackedRadixKey{}); });
+}
+REGISTER_SORT(PackedLSDRadixSort, "LSD Radix Sort (Packed)", 2.25, PackedLSDRadixSort);
+
+// ------------------------------
+// SIMD Merge Sort (Packed, Stable)
+// ------------------------------
+// Records become (key, position) words; blocks of SIMD_LEAF_MAX are sorted by the network, then
+// merged pairwise by the vector merge kernel, and the records are gathered once at the end
+inline void SimdMergeSort(vector<pair<int, int>>& arr) {
+    size_t n = arr.size();
+    if (n < 2) return;
+    vector<int64_t> words(n), buf(n);
+    for (size_t i = 0; i < n; ++i) words[i] = simdLeafWord(arr[i].first, static_cast<uint32_t>(i));
+
+    for (size_t lo = 0; lo < n; lo += SIMD_LEAF_MAX) sortWords(&words[lo], min(SIMD_LEAF_MAX, n - lo));
+    for (size_t width = SIMD_LEAF_MAX; width < n; width *= 2) {
+        for (size_t lo = 0; lo < n; lo += 2 * width) {
+            size_t mid = min(lo + width, n), hi = min(lo + 2 * width, n);
+            mergeWords(&words[lo], mid - lo, &words[mid], hi - mid, &buf[lo]);
+        }
+        words.swap(buf);
+    }
+
+    vector<pair<int, int>> records(arr);
+    for (size_t i = 0; i < n; ++i) arr[i] = records[static_cast<uint32_t>(words[i])];
+}
+REGISTER_SORT(SimdMergeSort, "SIMD Merge Sort (Packed)", 3, SimdMergeSort);
@@ -0,0 +1,167 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+#include "thread_pool.h"
+#include "sort_registry.h"
+#include "sort_traits.h"
+#include "advanced_sorts.h"
+
+using namespace std;
+
+// ------------------------------
+// Parallel Merge Sort (Stable)
+// ------------------------------
+const ptrdiff_t PARALLEL_MERGE_GRAIN = 1 << 14; // Below this many elements work stays on one thread
+
+// Stable merge of a[0, m) and b[0, n) into out, split into independent output chunks by co-ranking
+template <typename ItA, typename ItB, typename OutIt, typename Less>
+void parallelMerge(ItA a, ptrdiff_t m, ItB b, ptrdiff_t n, OutIt out, Less lt) {
+    ptrdiff_t total = m + n;
+    ptrdiff_t pieces = min<ptrdiff_t>(4 * parallelSortThreads(), total / PARALLEL_MERGE_GRAIN);
+    if (pieces <= 1) {
+        merge(make_move_iterator(a), make_move_iterator(a + m),
+              make_move_iterator(b), make_move_iterator(b + n), out, lt);
+        return;
+    }
+
+    parallelFor(pieces, [&](size_t p) {
+        ptrdiff_t k0 = total * p / pieces, k1 = total * (p + 1) / pieces;
+        ptrdiff_t i0 = coRank(k0, a, m, b, n, lt), i1 = coRank(k1, a, m, b, n, lt);
+        merge(make_move_iterator(a + i0), make_move_iterator(a + i1),
+              make_move_iterator(b + (k0 - i0)), make_move_iterator(b + (k1 - i1)), out + k0, lt);
+    });
+}
+
+// Sorts arr[0, n); the result lands in buf if resultInBuf, else back in arr.
+// Halves are sorted into the opposite array so each level merges without an extra copy.
+template <typename RandomIt, typename BufIt, typename Less>
+void parallelMergeSortInto(RandomIt arr, BufIt buf, ptrdiff_t n, bool resultInBuf, ptrdiff_t leaf, Less lt) {
+    if (n <= leaf) {
+        TimSort(arr, arr + n, IdentityKey{}, lt);
+        if (resultInBuf) move(arr, arr + n, buf);
+        return;
+    }
+
+    ptrdiff_t half = n / 2;
+    {
+        TaskGroup group(parallelSortPool());
+        group.run([&] { parallelMergeSortInto(arr, buf, half, !resultInBuf, leaf, lt); });
+        parallelMergeSortInto(arr + half, buf + half, n - half, !resultInBuf, leaf, lt);
+        group.wait();
+    }
+
+    if (resultInBuf) parallelMerge(arr, half, arr + half, n - half, buf, lt);
+    else parallelMerge(buf, half, buf + half, n - half, arr, lt);
+}
+
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void ParallelMergeSort(RandomIt first, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    ptrdiff_t n = last - first;
+    auto lt = makeKeyLess(key, comp);
+
+    unsigned threads = parallelSortThreads();
+    if (threads == 1 || n <= PARALLEL_MERGE_GRAIN) {
+        TimSort(first, last, key, comp);
+        return;
+    }
+
+    // About four leaves per thread so uneven leaves still balance out
+    ptrdiff_t leaf = max<ptrdiff_t>(PARALLEL_MERGE_GRAIN, n / (4 * threads));
+    vector<T> buf(n);
+    parallelMergeSortInto(first, buf.begin(), n, false, leaf, lt);
+}
+
+inline void ParallelMergeSort(vector<pair<int, int>>& arr) {
+    ParallelMergeSort(arr.begin(), arr.end());
+}
+REGISTER_RANGE_SORT(ParallelMergeSort, "Parallel Merge Sort", 0.5, ParallelMergeSort);
+
+// ------------------------------
+// Parallel Sample Sort (Unstable)
+// ------------------------------
+const size_t SAMPLE_SORT_OVERSAMPLING = 32; // Samples drawn per bucket when choosing splitters
+
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void ParallelSampleSort(RandomIt first, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    size_t n = last - first;
+    auto lt = makeKeyLess(key, comp);
+
+    unsigned threads = parallelSortThreads();
+    if (threads == 1 || n <= static_cast<size_t>(PARALLEL_MERGE_GRAIN)) {
+        IntroSort(first, last, key, comp);
+        return;
+    }
+
+    // Choose up to targetBuckets - 1 splitters from an evenly strided, sorted sample
+    size_t targetBuckets = min<size_t>(4 * threads, 32767);
+    size_t sampleSize = min(n, targetBuckets * SAMPLE_SORT_OVERSAMPLING);
+    vector<T> sample;
+    sample.reserve(sampleSize);
+    for (size_t i = 0; i < sampleSize; ++i)
+        sample.push_back(first[i * n / sampleSize]);
+    IntroSort(sample.begin(), sample.end(), key, comp);
+
+    // Repeated splitters are dropped and every splitter gets an equality bucket: bucket 2j holds the keys
+    // between splitters j - 1 and j, bucket 2j + 1 the keys equal to splitter j. A heavy key (AllEqual,
+    // FewUnique, Zipf) then fills an equality bucket, which needs no sort, instead of one thread's bucket.
+    vector<T> splitters;
+    for (size_t b = 1; b < targetBuckets; ++b) {
+        const T& s = sample[b * sampleSize / targetBuckets];
+        if (splitters.empty() || lt(splitters.back(), s)) splitters.push_back(s);
+    }
+    size_t buckets = 2 * splitters.size() + 1;
+
+    // Phase 1: classify each block's elements and count them per bucket
+    size_t blocks = threads;
+    vector<uint16_t> bucketOf(n);
+    vector<size_t> counts(blocks * buckets, 0);
+    parallelFor(blocks, [&](size_t blk) {
+        size_t lo = n * blk / blocks, hi = n * (blk + 1) / blocks;
+        size_t* cnt = &counts[blk * buckets];
+        for (size_t i = lo; i < hi; ++i) {
+            size_t j = lower_bound(splitters.begin(), splitters.end(), first[i], lt) - splitters.begin();
+            size_t b = 2 * j + (j < splitters.size() && !lt(first[i], splitters[j]));
+            bucketOf[i] = static_cast<uint16_t>(b);
+            ++cnt[b];
+        }
+    });
+
+    // Exclusive prefix sum in bucket-major order gives each (block, bucket) its output offset
+    vector<size_t> bucketStart(buckets + 1, 0);
+    size_t offset = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+        bucketStart[b] = offset;
+        for (size_t blk = 0; blk < blocks; ++blk) {
+            size_t c = counts[blk * buckets + b];
+            counts[blk * buckets + b] = offset;
+            offset += c;
+        }
+    }
+    bucketStart[buckets] = n;
+
+    // Phase 2: scatter into the buffer
+    vector<T> buf(n);
+    parallelFor(blocks, [&](size_t blk) {
+        size_t lo = n * blk / blocks, hi = n * (blk + 1) / blocks;
+        size_t* pos = &counts[blk * buckets];
+        for (size_t i = lo; i < hi; ++i)
+            buf[pos[bucketOf[i]]++] = std::move(first[i]);
+    });
+
+    // Phase 3: sort each range bucket independently (equality buckets already are) and move it back
+    parallelFor(buckets, [&](size_t b) {
+        auto bucketBegin = buf.begin() + bucketStart[b], bucketEnd = buf.begin() + bucketStart[b + 1];
+        if (b % 2 == 0) IntroSort(bucketBegin, bucketEnd, key, comp);
+        move(bucketBegin, bucketEnd, first + bucketStart[b]);
+    });
+}
+
+inline void ParallelSampleSort(vector<pair<int, int>>& arr) {
+    ParallelSampleSort(arr.begin(), arr.end());
+}
+REGISTER_RANGE_SORT(ParallelSampleSort, "Parallel Sample Sort", 1.5, ParallelSampleSort);
@@ -0,0 +1,129 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+
+// ------------------------------
+// Hardware Performance Counters
+// ------------------------------
+const int PERF_EVENT_COUNT = 6;
+
+// Column names, in the order the counters are opened and reported
+inline const array<string, PERF_EVENT_COUNT>& perfEventNames() {
+    static const array<string, PERF_EVENT_COUNT> names = {
+        "Cycles", "Instructions", "BranchMisses", "L1DMisses", "LLCMisses", "DTLBMisses"
+    };
+    return names;
+}
+
+// One reading per counter; an event the host can't count stays unavailable
+struct PerfSample {
+    array<uint64_t, PERF_EVENT_COUNT> values{};
+    array<bool, PERF_EVENT_COUNT> available{};
+};
+
+// Counts user-space events of the calling thread between start() and stop() via perf_event_open, plus
+// those of every thread it creates after the counters open (inherit), so pool workers are included.
+// Each event gets its own fd, so a host without (say) LLC events still reports the rest;
+// with no PMU at all (containers, most VMs) every event is simply unavailable.
+class PerfCounters {
+public:
+    PerfCounters() {
+        // Hardware cache events encode cache id | op << 8 | result << 16
+        auto cacheMiss = [](uint64_t cache) {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+        const pair<uint32_t, uint64_t> events[PERF_EVENT_COUNT] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D)},
+            {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL)},
+            {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_DTLB)},
+        };
+
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[e].first;
+            attr.config = events[e].second;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.inherit = 1; // Reset, enable, disable and read cover the inherited per-thread counters too
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+    }
+
+    ~PerfCounters() {
+        for (int fd : fds)
+            if (fd >= 0) close(fd);
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // True if at least one event could be opened
+    bool any() const {
+        for (int fd : fds)
+            if (fd >= 0) return true;
+        return false;
+    }
+
+    void start() {
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    PerfSample stop() {
+        for (int fd : fds)
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+        PerfSample sample;
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (fds[e] < 0) continue;
+            uint64_t buf[3]; // value, time enabled, time running
+            if (read(fds[e], buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)) || buf[2] == 0) continue;
+
+            // Scale up if the kernel multiplexed this counter with others
+            double scale = static_cast<double>(buf[1]) / buf[2];
+            sample.values[e] = static_cast<uint64_t>(buf[0] * scale);
+            sample.available[e] = true;
+        }
+        return sample;
+    }
+
+private:
+    array<int, PERF_EVENT_COUNT> fds;
+};
+
+// ------------------------------
+// Counter Mode Configuration
+// ------------------------------
+inline bool& perfCountersSetting() {
+    static bool enabled = false;
+    return enabled;
+}
+
+// Counters are off by default; main turns them on with --counters
+inline bool perfCountersEnabled() { return perfCountersSetting(); }
+inline void setPerfCountersEnabled(bool enabled) { perfCountersSetting() = enabled; }
+
+// Counters shared by the harness, opened on first use
+inline PerfCounters& harnessPerfCounters() {
+    static PerfCounters counters;
+    return counters;
+}
@@ -0,0 +1,230 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include "sort_registry.h"
+#include "sort_traits.h"
+
+using namespace std;
+
+// ------------------------------
+// Radix Key Mapping
+// ------------------------------
+const int RADIX_BITS = 8;                  // Bits per digit in the MSD sort
+const size_t RADIX_BUCKETS = 1 << RADIX_BITS;
+
+// Maps an integer key to an unsigned value with the same ordering.
+// Flipping the sign bit moves negative keys below the positive ones.
+template <typename K>
+constexpr make_unsigned_t<K> radixOrderedKey(K k) {
+    static_assert(is_integral<K>::value, "radix sorts need an integral key");
+    using U = make_unsigned_t<K>;
+    U u = static_cast<U>(k);
+    if (is_signed<K>::value) u ^= U(1) << (sizeof(K) * CHAR_BIT - 1);
+    return u;
+}
+
+// ------------------------------
+// LSD Radix Sort (Stable)
+// ------------------------------
+const int LSD_MAX_DIGIT_BITS = 11; // Widest digit; 2^11 counters still fit in L1
+
+// One counting pass from src into dst on the digit (mapped key - base) >> shift; offsets holds each
+// bucket's start and is advanced
+template <typename SrcIt, typename DstIt, typename KeyFn, typename U>
+void radixScatterPass(SrcIt src, DstIt dst, size_t n, U base, int shift, U mask, size_t* offsets, KeyFn key) {
+    for (size_t i = 0; i < n; ++i) {
+        size_t d = ((radixOrderedKey(key(src[i])) - base) >> shift) & mask;
+        dst[offsets[d]++] = std::move(src[i]);
+    }
+}
+
+template <typename RandomIt, typename KeyFn = FirstKey>
+void LSDRadixSort(RandomIt first, RandomIt last, KeyFn key = {}) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    using K = decay_t<decltype(key(*first))>;
+    using U = make_unsigned_t<K>;
+    size_t n = last - first;
+    if (n < 2) return;
+
+    // Only the bits that vary between min and max need sorting: bounded key ranges take fewer passes
+    U lo = radixOrderedKey(key(first[0])), hi = lo;
+    for (size_t i = 1; i < n; ++i) {
+        U u = radixOrderedKey(key(first[i]));
+        lo = min(lo, u);
+        hi = max(hi, u);
+    }
+    int bits = 0;
+    for (U range = hi - lo; range != 0; range >>= 1) ++bits;
+    if (bits == 0) return; // All keys equal
+
+    // Split the significant bits evenly into as few digits of at most LSD_MAX_DIGIT_BITS as possible
+    int passes = (bits + LSD_MAX_DIGIT_BITS - 1) / LSD_MAX_DIGIT_BITS;
+    int digitBits = (bits + passes - 1) / passes;
+    size_t buckets = size_t(1) << digitBits;
+    U mask = static_cast<U>(buckets - 1);
+
+    // Histograms for every digit in a single pass over the input
+    vector<size_t> counts(passes * buckets, 0);
+    for (size_t i = 0; i < n; ++i) {
+        U u = radixOrderedKey(key(first[i])) - lo;
+        for (int d = 0; d < passes; ++d)
+            ++counts[d * buckets + ((u >> (d * digitBits)) & mask)];
+    }
+
+    // Ping-pong between the input and one buffer; digits shared by every key are skipped
+    vector<T> buf(n);
+    bool inBuf = false;
+    for (int d = 0; d < passes; ++d) {
+        size_t* cnt = &counts[d * buckets];
+        if (*max_element(cnt, cnt + buckets) == n) continue;
+
+        size_t offset = 0;
+        for (size_t b = 0; b < buckets; ++b) {
+            size_t c = cnt[b];
+            cnt[b] = offset;
+            offset += c;
+        }
+
+        if (inBuf) radixScatterPass(buf.begin(), first, n, lo, d * digitBits, mask, cnt, key);
+        else radixScatterPass(first, buf.begin(), n, lo, d * digitBits, mask, cnt, key);
+        inBuf = !inBuf;
+    }
+
+    if (inBuf) move(buf.begin(), buf.end(), first);
+}
+
+inline void LSDRadixSort(vector<pair<int, int>>& arr) {
+    LSDRadixSort(arr.begin(), arr.end());
+}
+REGISTER_RANGE_SORT(LSDRadixSort, "LSD Radix Sort", 1.25, LSDRadixSort);
+
+// ------------------------------
+// MSD Radix Sort (American Flag, In-place, Unstable)
+// ------------------------------
+const ptrdiff_t MSD_INSERTION_SORT_THRESHOLD = 32; // Buckets below this are insertion sorted
+
+// Sorts on digit ((mapped key - base) >> shift) and recurses on the next lower digit.
+// Shifts are clamped at 0, so a final digit may overlap bits already sorted on; that is harmless.
+template <typename RandomIt, typename KeyFn, typename U>
+void americanFlagSort(RandomIt first, RandomIt last, int shift, U base, KeyFn key) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    ptrdiff_t n = last - first;
+
+    // Small buckets: insertion sort on the full mapped key
+    if (n < MSD_INSERTION_SORT_THRESHOLD) {
+        for (ptrdiff_t i = 1; i < n; ++i) {
+            T cur = std::move(first[i]);
+            auto k = radixOrderedKey(key(cur));
+            ptrdiff_t j = i - 1;
+            while (j >= 0 && radixOrderedKey(key(first[j])) > k) {
+                first[j + 1] = std::move(first[j]);
+                --j;
+            }
+            first[j + 1] = std::move(cur);
+        }
+        return;
+    }
+
+    auto digitOf = [&](const T& rec) {
+        return static_cast<size_t>(((radixOrderedKey(key(rec)) - base) >> shift) & (RADIX_BUCKETS - 1));
+    };
+
+    size_t counts[RADIX_BUCKETS] = {};
+    for (ptrdiff_t i = 0; i < n; ++i) ++counts[digitOf(first[i])];
+
+    // Every key shares this digit: go straight to the next one
+    if (*max_element(counts, counts + RADIX_BUCKETS) == static_cast<size_t>(n)) {
+        if (shift > 0) americanFlagSort(first, last, max(shift - RADIX_BITS, 0), base, key);
+        return;
+    }
+
+    size_t next[RADIX_BUCKETS], end[RADIX_BUCKETS];
+    size_t offset = 0;
+    for (size_t b = 0; b < RADIX_BUCKETS; ++b) {
+        next[b] = offset;
+        offset += counts[b];
+        end[b] = offset;
+    }
+
+    // Permute in place: carry each misplaced element along its cycle in a register,
+    // dropping it into its bucket and picking up the element it displaces
+    for (size_t b = 0; b < RADIX_BUCKETS; ++b) {
+        while (next[b] < end[b]) {
+            T cur = std::move(first[next[b]]);
+            size_t d = digitOf(cur);
+            while (d != b) {
+                swap(cur, first[next[d]++]);
+                d = digitOf(cur);
+            }
+            first[next[b]++] = std::move(cur);
+        }
+    }
+
+    if (shift == 0) return;
+    size_t start = 0;
+    for (size_t b = 0; b < RADIX_BUCKETS; ++b) {
+        if (counts[b] > 1)
+            americanFlagSort(first + start, first + start + counts[b], max(shift - RADIX_BITS, 0), base, key);
+        start += counts[b];
+    }
+}
+
+template <typename RandomIt, typename KeyFn = FirstKey>
+void MSDRadixSort(RandomIt first, RandomIt last, KeyFn key = {}) {
+    using K = decay_t<decltype(key(*first))>;
+    using U = make_unsigned_t<K>;
+    if (last - first < 2) return;
+
+    // Start at the highest bit that varies, so bounded key ranges skip the constant top digits
+    U lo = radixOrderedKey(key(*first)), hi = lo;
+    for (RandomIt it = first + 1; it != last; ++it) {
+        U u = radixOrderedKey(key(*it));
+        lo = min(lo, u);
+        hi = max(hi, u);
+    }
+    int bits = 0;
+    for (U range = hi - lo; range != 0; range >>= 1) ++bits;
+    if (bits == 0) return; // All keys equal
+
+    americanFlagSort(first, last, max(bits - RADIX_BITS, 0), lo, key);
+}
+
+inline void MSDRadixSort(vector<pair<int, int>>& arr) {
+    MSDRadixSort(arr.begin(), arr.end());
+}
+REGISTER_RANGE_SORT(MSDRadixSort, "MSD Radix Sort", 0, MSDRadixSort);
+
+// ------------------------------
+// Counting Sort (Stable)
+// ------------------------------
+// O(n + k) sort for keys in [minKey, minKey + range); returns the number of distinct keys seen
+template <typename RandomIt, typename KeyFn, typename K>
+size_t CountingSort(RandomIt first, RandomIt last, K minKey, size_t range, KeyFn key) {
+    using T = typename iterator_traits<RandomIt>::value_type;
+    size_t n = last - first;
+    if (n < 2) return n;
+
+    auto slotOf = [&](const T& rec) {
+        return static_cast<size_t>(radixOrderedKey(key(rec)) - radixOrderedKey(minKey));
+    };
+
+    // Count each key, then turn counts into starting offsets
+    vector<size_t> counts(range + 1, 0);
+    for (RandomIt it = first; it != last; ++it) ++counts[slotOf(*it) + 1];
+    size_t distinct = 0;
+    for (size_t k = 1; k <= range; ++k) {
+        distinct += counts[k] != 0;
+        counts[k] += counts[k - 1];
+    }
+
+    // Stable scatter into a buffer and back
+    vector<T> buf(n);
+    for (RandomIt it = first; it != last; ++it) buf[counts[slotOf(*it)]++] = std::move(*it);
+    move(buf.begin(), buf.end(), first);
+    return distinct;
+}
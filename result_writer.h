@@ -0,0 +1,114 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "perf_counters.h"
+
+using namespace std;
+
+// ------------------------------
+// Result Rows
+// ------------------------------
+// Column order shared by every row and output format
+inline const vector<string>& resultColumns() {
+    static const vector<string> columns = [] {
+        vector<string> cols = {
+            "Algorithm", "Size", "InputType", "Seed", "RecordBytes", "Time", "Runs", "MinTime", "P90Time", "P99Time", "StdDevTime",
+            "Allocations", "AllocatedBytes", "PeakHeapBytes", "InversionBefore", "InversionAfter",
+            "SortStatus", "Stability", "StablePercent",
+            "BytesRead", "BytesWritten", "MergePasses", "RunPhaseTime", "RunPhaseMBps", "MergePhaseTime", "MergePhaseMBps"
+        };
+        for (const auto& event : perfEventNames()) cols.push_back(event);
+        return cols;
+    }();
+    return columns;
+}
+
+// One result; cells that are never set read "-"
+struct ResultRow {
+    vector<string> cells = vector<string>(resultColumns().size(), "-");
+
+    void set(const string& column, const string& value) {
+        const auto& cols = resultColumns();
+        cells[find(cols.begin(), cols.end(), column) - cols.begin()] = value;
+    }
+    void set(const string& column, const char* value) { set(column, string(value)); }
+
+    template <typename T>
+    void set(const string& column, const T& value) {
+        ostringstream cell;
+        cell << value;
+        set(column, cell.str());
+    }
+};
+
+// ------------------------------
+// Result Writer
+// ------------------------------
+enum class OutputFormat { Csv, Json };
+
+// Writes rows as CSV (header first) or JSON Lines (one object per row, "-" as null)
+class ResultWriter {
+public:
+    bool open(const string& path, OutputFormat outputFormat) {
+        out.open(path);
+        format = outputFormat;
+        if (!out) return false;
+        if (format == OutputFormat::Csv) writeCsvLine(resultColumns());
+        return true;
+    }
+
+    void write(const ResultRow& row) {
+        if (!out.is_open()) return;
+        if (format == OutputFormat::Csv) {
+            writeCsvLine(row.cells);
+            return;
+        }
+
+        const auto& cols = resultColumns();
+        out << "{";
+        for (size_t i = 0; i < cols.size(); ++i)
+            out << (i ? "," : "") << jsonString(cols[i]) << ":" << jsonValue(row.cells[i]);
+        out << "}\n";
+    }
+
+    void close() { out.close(); }
+
+private:
+    void writeCsvLine(const vector<string>& cells) {
+        for (size_t i = 0; i < cells.size(); ++i) out << (i ? "," : "") << cells[i];
+        out << "\n";
+    }
+
+    static string jsonString(const string& s) {
+        string quoted = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\') quoted += '\\';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    // Numbers are written bare, "-" (not measured) as null, anything else as a string
+    static string jsonValue(const string& cell) {
+        if (cell == "-") return "null";
+        char* end = nullptr;
+        bool numeric = !cell.empty() && (isdigit(static_cast<unsigned char>(cell[0])) || cell[0] == '-');
+        if (numeric) strtod(cell.c_str(), &end);
+        return numeric && *end == '\0' ? cell : jsonString(cell);
+    }
+
+    ofstream out;
+    OutputFormat format = OutputFormat::Csv;
+};
+
+// Output the harness writes to; main opens it
+inline ResultWriter& resultWriter() {
+    static ResultWriter writer;
+    return writer;
+}
@@ -0,0 +1,197 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+#include "basic_sorts.h"
+#include "sort_traits.h"
+
+using namespace std;
+
+// ------------------------------
+// Selection: nth Element, Partial Sort, Top-k
+// ------------------------------
+// Answers "which record is k-th" and "which are the k smallest" without sorting all n records: selection
+// narrows to the side of each partition that holds the k-th position (O(n) expected), and the top-k sorts
+// keep a bounded max-heap of the k smallest records seen (O(n log k)). Same key/comparator interface as
+// the sorts; none of them is stable.
+const ptrdiff_t SELECT_SMALL_RANGE = 32;            // Ranges this small are sorted outright
+const ptrdiff_t FLOYD_RIVEST_SAMPLE_THRESHOLD = 600; // Ranges above this pick their pivot from a sample
+
+// Sorts a range that selection has narrowed down to a few records
+template <typename RandomIt, typename Less>
+void sortSelectedRange(RandomIt first, RandomIt last, Less lt) {
+    if (!sortSmallRange(first, last, lt)) insertionSortRange(first, last, lt);
+}
+
+// Leaves the smallest middle - first records of [first, last) in [first, middle) as a D-ary max-heap
+template <size_t D, typename RandomIt, typename Less>
+void heapSelectWithArity(RandomIt first, RandomIt middle, RandomIt last, Less lt) {
+    ptrdiff_t k = middle - first;
+    makeHeap<D>(first, k, lt);
+
+    // A record below the heap's largest replaces it; the largest goes to the record's slot
+    for (RandomIt it = middle; it != last; ++it) {
+        if (!lt(*it, first[0])) continue;
+        auto value = std::move(*it);
+        *it = std::move(first[0]);
+        heapSiftDown<D>(first, k, 0, std::move(value), lt);
+    }
+}
+
+template <size_t D, typename RandomIt, typename Less>
+void partialSortWithArity(RandomIt first, RandomIt middle, RandomIt last, Less lt) {
+    heapSelectWithArity<D>(first, middle, last, lt);
+    sortHeap<D>(first, middle - first, lt);
+}
+
+// Heap select over [first, last) with a ready-made record comparator, at the heap sorts' arity
+template <typename RandomIt, typename Less>
+void heapSelectRange(RandomIt first, RandomIt middle, RandomIt last, Less lt) {
+    switch (heapArity(sizeof(typename iterator_traits<RandomIt>::value_type))) {
+        case 4: heapSelectWithArity<4>(first, middle, last, lt); break;
+        case 8: heapSelectWithArity<8>(first, middle, last, lt); break;
+        default: heapSelectWithArity<2>(first, middle, last, lt); break;
+    }
+}
+
+template <typename RandomIt, typename Less>
+void partialSortRange(RandomIt first, RandomIt middle, RandomIt last, Less lt) {
+    switch (heapArity(sizeof(typename iterator_traits<RandomIt>::value_type))) {
+        case 4: partialSortWithArity<4>(first, middle, last, lt); break;
+        case 8: partialSortWithArity<8>(first, middle, last, lt); break;
+        default: partialSortWithArity<2>(first, middle, last, lt); break;
+    }
+}
+
+// Introselect: quickselect on partitionRange (median-of-three), keeping only the side that holds nth.
+// After log2(n) badly unbalanced partitions (e.g. many equal keys) a heap select finishes in O(n log k).
+template <typename RandomIt, typename Less>
+void introSelectRange(RandomIt first, RandomIt nth, RandomIt last, Less lt) {
+    if (nth == last) return;
+    int badAllowed = static_cast<int>(log2(max<ptrdiff_t>(last - first, 2)));
+    while (last - first > SELECT_SMALL_RANGE) {
+        if (badAllowed == 0) {
+            heapSelectRange(first, nth + 1, last, lt);
+            iter_swap(first, nth);
+            return;
+        }
+        ptrdiff_t n = last - first;
+        RandomIt pivot = partitionRange(first, last, lt);
+        if (pivot == nth) return;
+        if (nth < pivot) last = pivot;
+        else first = pivot + 1;
+        if (last - first > n - n / 8) --badAllowed;
+    }
+    sortSelectedRange(first, last, lt);
+}
+
+// Floyd-Rivest select on a[left..right] (inclusive): large ranges first select k within a sample of about
+// n^(2/3) records around k's expected rank, so the pivot a[k] lands close to the answer and the Hoare
+// partition that follows leaves only a sliver of the range for the next round
+template <typename RandomIt, typename Less>
+void floydRivestSelect(RandomIt a, ptrdiff_t left, ptrdiff_t right, ptrdiff_t k, Less lt) {
+    while (right - left >= SELECT_SMALL_RANGE) {
+        if (right - left > FLOYD_RIVEST_SAMPLE_THRESHOLD) {
+            double n = right - left + 1;
+            double i = k - left + 1;
+            double z = log(n);
+            double s = 0.5 * exp(2 * z / 3);
+            double sd = 0.5 * sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1 : 1);
+            ptrdiff_t sampleLeft = max(left, static_cast<ptrdiff_t>(k - i * s / n + sd));
+            ptrdiff_t sampleRight = min(right, static_cast<ptrdiff_t>(k + (n - i) * s / n + sd));
+            floydRivestSelect(a, sampleLeft, sampleRight, k, lt);
+        }
+
+        // Partition around t = a[k]; a[left] and a[right] end up as sentinels for the scans
+        auto t = a[k];
+        ptrdiff_t i = left, j = right;
+        swap(a[left], a[k]);
+        if (lt(t, a[right])) swap(a[right], a[left]);
+        while (i < j) {
+            swap(a[i], a[j]);
+            ++i;
+            --j;
+            while (lt(a[i], t)) ++i;
+            while (lt(t, a[j])) --j;
+        }
+        if (!lt(a[left], t) && !lt(t, a[left])) {
+            swap(a[left], a[j]);
+        } else {
+            ++j;
+            swap(a[j], a[right]);
+        }
+
+        // t now sits at j, with nothing larger before it and nothing smaller after
+        if (j <= k) left = j + 1;
+        if (k <= j) right = j - 1;
+    }
+    if (right > left) sortSelectedRange(a + left, a + right + 1, lt);
+}
+
+// Rearranges [first, last) so that *nth is the record a full sort would put there, nothing after it is
+// smaller and nothing before it is larger
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void NthElement(RandomIt first, RandomIt nth, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    introSelectRange(first, nth, last, makeKeyLess(key, comp));
+}
+
+// NthElement by Floyd-Rivest: about n + min(k, n - k) comparisons, against roughly 3n for introselect
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void FloydRivestNthElement(RandomIt first, RandomIt nth, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    if (nth == last) return;
+    floydRivestSelect(first, 0, last - first - 1, nth - first, makeKeyLess(key, comp));
+}
+
+// Puts the middle - first smallest records of [first, last), sorted, in [first, middle); the rest are left
+// in no particular order
+template <typename RandomIt, typename KeyFn = FirstKey, typename Compare = less<>>
+void PartialSort(RandomIt first, RandomIt middle, RandomIt last, KeyFn key = {}, Compare comp = {}) {
+    if (middle == first) return;
+    partialSortRange(first, middle, last, makeKeyLess(key, comp));
+}
+
+// ------------------------------
+// Streaming Top-k
+// ------------------------------
+// The k smallest records of a stream that arrives a record or a batch at a time, in O(k) memory. A record
+// costs one comparison against the heap's largest unless it displaces it (O(log k)), so once the heap has
+// settled a long stream mostly streams past.
+template <typename T, typename KeyFn = FirstKey, typename Compare = less<>, size_t D = 4>
+class TopKStream {
+public:
+    explicit TopKStream(size_t k, KeyFn key = {}, Compare comp = {}) : limit(k), lt(makeKeyLess(key, comp)) {
+        heap.reserve(k);
+    }
+
+    void push(const T& rec) {
+        if (heap.size() < limit) {
+            heap.push_back(rec);
+            heapSiftUp<D>(heap.begin(), 0, heap.size() - 1, rec, lt);
+        } else if (limit > 0 && lt(rec, heap[0])) {
+            heapSiftDown<D>(heap.begin(), heap.size(), 0, rec, lt);
+        }
+    }
+
+    template <typename InputIt>
+    void push(InputIt first, InputIt last) {
+        for (; first != last; ++first) push(*first);
+    }
+
+    // The k smallest records pushed so far (fewer if fewer arrived), in order
+    vector<T> sorted() const {
+        vector<T> result = heap;
+        sortHeap<D>(result.begin(), result.size(), lt);
+        return result;
+    }
+
+    size_t size() const { return heap.size(); }
+    size_t k() const { return limit; }
+
+private:
+    size_t limit;
+    KeyLess<KeyFn, Compare> lt;
+    vector<T> heap; // Max-heap of the smallest records so far
+};
@@ -0,0 +1,497 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include <immintrin.h>
+
+#include "sort_traits.h"
+#include "sorting_networks.h"
+
+using namespace std;
+
+// ------------------------------
+// Runtime SIMD Dispatch
+// ------------------------------
+enum class SimdLevel { Scalar, Sse42, Avx2, Avx512 };
+
+inline SimdLevel detectSimdLevel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::Avx512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+    if (__builtin_cpu_supports("sse4.2")) return SimdLevel::Sse42;
+    return SimdLevel::Scalar;
+}
+
+inline SimdLevel& simdLevelSetting() {
+    static SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+// The best level the CPU has, unless lowered with setSimdLevel (--simd) to compare the paths
+inline SimdLevel simdLevel() { return simdLevelSetting(); }
+inline void setSimdLevel(SimdLevel level) { simdLevelSetting() = min(level, detectSimdLevel()); }
+
+// Whether the stable merge sorts merge (int, int) records through the word merge kernel (--simd-merge).
+// Off by default: packing and gathering the records costs about what the kernel saves over a scalar merge.
+inline bool& simdMergeSetting() {
+    static bool enabled = false;
+    return enabled;
+}
+inline void setSimdMerge(bool enabled) { simdMergeSetting() = enabled; }
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx512: return "avx512";
+        case SimdLevel::Avx2: return "avx2";
+        case SimdLevel::Sse42: return "sse4.2";
+        default: return "scalar";
+    }
+}
+
+// ------------------------------
+// Bitonic Kernels on 64-bit Words
+// ------------------------------
+// The kernels sort signed 64-bit words. They are written once with GCC vector extensions and
+// compiled per instruction set by inlining them into target-specific entry points: 4 lanes per
+// AVX2 register, 2 per SSE4.2 register (pcmpgtq is SSE4.2).
+#define SIMD_INLINE inline __attribute__((always_inline))
+
+using Words4 = int64_t __attribute__((vector_size(32)));
+using Words2 = int64_t __attribute__((vector_size(16)));
+
+const size_t SIMD_LEAF_MAX = 64; // Largest block one sorting network handles
+
+template <typename V>
+SIMD_INLINE void minMax(V& a, V& b) {
+    V lt = a < b;
+    V lo = lt ? a : b;
+    b = lt ? b : a;
+    a = lo;
+}
+
+// Compare-exchange of every lane with lane ^ dist (mirror: lane ^ (2 * dist - 1)), low lanes keeping the min
+template <typename V, int L>
+SIMD_INLINE void exchangeInVector(V& x, int dist, bool mirror) {
+    V partner, takeMax;
+    if constexpr (L == 4) {
+        if (dist == 1) partner = __builtin_shuffle(x, Words4{1, 0, 3, 2}), takeMax = Words4{0, -1, 0, -1};
+        else if (mirror) partner = __builtin_shuffle(x, Words4{3, 2, 1, 0}), takeMax = Words4{0, 0, -1, -1};
+        else partner = __builtin_shuffle(x, Words4{2, 3, 0, 1}), takeMax = Words4{0, 0, -1, -1};
+    } else {
+        partner = __builtin_shuffle(x, Words2{1, 0});
+        takeMax = Words2{0, -1};
+    }
+    V lt = x < partner;
+    V lo = lt ? x : partner, hi = lt ? partner : x;
+    x = takeMax ? hi : lo;
+}
+
+template <typename V, int L>
+SIMD_INLINE void reverseLanes(V& x) {
+    if constexpr (L == 4) x = __builtin_shuffle(x, Words4{3, 2, 1, 0});
+    else x = __builtin_shuffle(x, Words2{1, 0});
+}
+
+// Bitonic sort of NV vectors (L * NV words, a power of two) in the "flip" form: each stage first
+// compares i with i ^ (k - 1), after which every half-cleaner is ascending, so no per-lane directions
+template <typename V, int L, int NV>
+SIMD_INLINE void bitonicSortVectors(V* a) {
+    constexpr int N = L * NV;
+#pragma GCC unroll 8
+    for (int k = 2; k <= N; k *= 2) {
+        if (k <= L) {
+#pragma GCC unroll 32
+            for (int v = 0; v < NV; ++v) exchangeInVector<V, L>(a[v], k / 2, true);
+        } else {
+            int kv = k / L;
+#pragma GCC unroll 32
+            for (int b = 0; b < NV; b += kv) {
+#pragma GCC unroll 32
+                for (int t = 0; t < kv / 2; ++t) {
+                    V r = a[b + kv - 1 - t];
+                    reverseLanes<V, L>(r);
+                    minMax(a[b + t], r);
+                    reverseLanes<V, L>(r);
+                    a[b + kv - 1 - t] = r;
+                }
+            }
+        }
+#pragma GCC unroll 8
+        for (int j = k / 4; j >= 1; j /= 2) {
+            if (j >= L) {
+                int d = j / L;
+#pragma GCC unroll 32
+                for (int v = 0; v < NV; ++v)
+                    if (!(v & d)) minMax(a[v], a[v + d]);
+            } else {
+#pragma GCC unroll 32
+                for (int v = 0; v < NV; ++v) exchangeInVector<V, L>(a[v], j, false);
+            }
+        }
+    }
+}
+
+// Sorts w[0, n) for L * NV / 2 < n <= L * NV: loads straight from w, padding the last vectors with the
+// largest word, and stores the first n words back
+template <typename V, int L, int NV>
+SIMD_INLINE void sortWordBlock(int64_t* w, size_t n) {
+    V a[NV];
+    size_t full = n / L;
+#pragma GCC unroll 32
+    for (int v = 0; v < NV; ++v) {
+        if (static_cast<size_t>(v) < full) {
+            memcpy(&a[v], w + v * L, sizeof(V));
+        } else {
+            for (int i = 0; i < L; ++i) a[v][i] = v * L + i < static_cast<int>(n) ? w[v * L + i] : INT64_MAX;
+        }
+    }
+    bitonicSortVectors<V, L, NV>(a);
+#pragma GCC unroll 32
+    for (int v = 0; v < NV; ++v) {
+        if (static_cast<size_t>(v) < full) {
+            memcpy(w + v * L, &a[v], sizeof(V));
+        } else {
+            for (int i = 0; i < L && v * L + i < static_cast<int>(n); ++i) w[v * L + i] = a[v][i];
+        }
+    }
+}
+
+// Sorts w[0, n), n <= SIMD_LEAF_MAX, with one network of the next power of two (at least two vectors)
+template <typename V, int L>
+SIMD_INLINE void sortWordsKernel(int64_t* w, size_t n) {
+    if (n <= 2 * L) sortWordBlock<V, L, 2>(w, n);
+    else if (n <= 4 * L) sortWordBlock<V, L, 4>(w, n);
+    else if (n <= 8 * L) sortWordBlock<V, L, 8>(w, n);
+    else if (n <= 16 * L || L * 16 >= static_cast<int>(SIMD_LEAF_MAX)) sortWordBlock<V, L, 16>(w, n);
+    else if constexpr (32 * L <= SIMD_LEAF_MAX) sortWordBlock<V, L, 32>(w, n);
+}
+
+// One merge of sorted a[0, na) and b[0, nb) into out. Each step merges the L carried-over largest words
+// with the next L from whichever input has the smaller head and emits the lower half (a bitonic merge of
+// two registers); finish() takes the last partial blocks through a scalar three-way merge.
+template <typename V, int L>
+struct WordMerge {
+    const int64_t* a;
+    const int64_t* b;
+    size_t na, nb, ia = 0, ib = 0;
+    int64_t* out;
+    V lo{}, hi{};
+    bool vectorized, active; // Whether the vector steps ran at all, and whether they still can
+
+    SIMD_INLINE WordMerge(const int64_t* a, size_t na, const int64_t* b, size_t nb, int64_t* out)
+        : a(a), b(b), na(na), nb(nb), out(out), vectorized(na >= L && nb >= L), active(vectorized) {
+        if (vectorized) {
+            memcpy(&lo, a, sizeof(V));
+            memcpy(&hi, b, sizeof(V));
+            ia = ib = L;
+        }
+    }
+
+    SIMD_INLINE void step() {
+        reverseLanes<V, L>(hi);
+        minMax(lo, hi);
+        for (int j = L / 2; j >= 1; j /= 2) {
+            exchangeInVector<V, L>(lo, j, false);
+            exchangeInVector<V, L>(hi, j, false);
+        }
+        memcpy(out, &lo, sizeof(V));
+        out += L;
+
+        bool fromA = ia < na && (ib >= nb || a[ia] < b[ib]);
+        if (fromA ? ia + L > na : ib + L > nb) {
+            active = false;
+            return;
+        }
+        memcpy(&lo, fromA ? a + ia : b + ib, sizeof(V));
+        (fromA ? ia : ib) += L;
+    }
+
+    SIMD_INLINE void finish() {
+        while (active) step();
+
+        // Scalar tail over three sorted sequences: the carried words and both remainders
+        alignas(32) int64_t carry[L];
+        size_t ic = 0, carried = vectorized ? L : 0;
+        if (vectorized) memcpy(carry, &hi, sizeof(V));
+        while (ic < carried || ia < na || ib < nb) {
+            int64_t best = INT64_MAX;
+            int from = -1;
+            if (ic < carried) best = carry[ic], from = 0;
+            if (ia < na && (from < 0 || a[ia] < best)) best = a[ia], from = 1;
+            if (ib < nb && (from < 0 || b[ib] < best)) best = b[ib], from = 2;
+            *out++ = best;
+            if (from == 0) ++ic;
+            else if (from == 1) ++ia;
+            else ++ib;
+        }
+    }
+};
+
+template <typename V, int L>
+SIMD_INLINE void mergeWordsKernel(const int64_t* a, size_t na, const int64_t* b, size_t nb, int64_t* out) {
+    WordMerge<V, L>(a, na, b, nb, out).finish();
+}
+
+// Two independent merges stepped in lockstep: each step is a chain of dependent shuffles and compares,
+// and interleaving a second chain keeps the vector units busy during its latency
+template <typename V, int L>
+SIMD_INLINE void mergeWordsPairKernel(const int64_t* a1, size_t na1, const int64_t* b1, size_t nb1, int64_t* out1,
+                                      const int64_t* a2, size_t na2, const int64_t* b2, size_t nb2, int64_t* out2) {
+    WordMerge<V, L> first(a1, na1, b1, nb1, out1), second(a2, na2, b2, nb2, out2);
+    while (first.active && second.active) {
+        first.step();
+        second.step();
+    }
+    first.finish();
+    second.finish();
+}
+
+__attribute__((target("avx2"))) inline void sortWordsAvx2(int64_t* w, size_t n) { sortWordsKernel<Words4, 4>(w, n); }
+__attribute__((target("sse4.2"))) inline void sortWordsSse42(int64_t* w, size_t n) { sortWordsKernel<Words2, 2>(w, n); }
+
+__attribute__((target("avx2"))) inline void mergeWordsAvx2(const int64_t* a, size_t na, const int64_t* b, size_t nb,
+                                                           int64_t* out) {
+    mergeWordsKernel<Words4, 4>(a, na, b, nb, out);
+}
+__attribute__((target("sse4.2"))) inline void mergeWordsSse42(const int64_t* a, size_t na, const int64_t* b, size_t nb,
+                                                              int64_t* out) {
+    mergeWordsKernel<Words2, 2>(a, na, b, nb, out);
+}
+__attribute__((target("avx2"))) inline void mergeWordsPairAvx2(const int64_t* a1, size_t na1, const int64_t* b1,
+                                                               size_t nb1, int64_t* out1, const int64_t* a2, size_t na2,
+                                                               const int64_t* b2, size_t nb2, int64_t* out2) {
+    mergeWordsPairKernel<Words4, 4>(a1, na1, b1, nb1, out1, a2, na2, b2, nb2, out2);
+}
+__attribute__((target("sse4.2"))) inline void mergeWordsPairSse42(const int64_t* a1, size_t na1, const int64_t* b1,
+                                                                  size_t nb1, int64_t* out1, const int64_t* a2,
+                                                                  size_t na2, const int64_t* b2, size_t nb2,
+                                                                  int64_t* out2) {
+    mergeWordsPairKernel<Words2, 2>(a1, na1, b1, nb1, out1, a2, na2, b2, nb2, out2);
+}
+
+// Sorts w[0, n) for n <= SIMD_LEAF_MAX with the best available network (AVX-512 hosts run the AVX2 one);
+// on the scalar level, the compile-time network up to SORTING_NETWORK_MAX words, else insertion sort
+inline void sortWords(int64_t* w, size_t n) {
+    switch (simdLevel()) {
+        case SimdLevel::Avx512:
+        case SimdLevel::Avx2: sortWordsAvx2(w, n); break;
+        case SimdLevel::Sse42: sortWordsSse42(w, n); break;
+        default:
+            if (networkSort(w, w + n, less<>{})) break;
+            for (size_t i = 1; i < n; ++i) {
+                int64_t cur = w[i];
+                size_t j = i;
+                for (; j > 0 && cur < w[j - 1]; --j) w[j] = w[j - 1];
+                w[j] = cur;
+            }
+    }
+}
+
+// Merges two sorted word arrays into out
+inline void mergeWords(const int64_t* a, size_t na, const int64_t* b, size_t nb, int64_t* out) {
+    if (na == 0 || nb == 0 || a[na - 1] < b[0]) {
+        copy(b, b + nb, copy(a, a + na, out));
+        return;
+    }
+    switch (simdLevel()) {
+        case SimdLevel::Avx512:
+        case SimdLevel::Avx2: mergeWordsAvx2(a, na, b, nb, out); break;
+        case SimdLevel::Sse42: mergeWordsSse42(a, na, b, nb, out); break;
+        default: merge(a, a + na, b, b + nb, out);
+    }
+}
+
+// Two independent merges at once, as mergeWords each; faster than two calls where the kernel is vectorized
+inline void mergeWordsPair(const int64_t* a1, size_t na1, const int64_t* b1, size_t nb1, int64_t* out1,
+                           const int64_t* a2, size_t na2, const int64_t* b2, size_t nb2, int64_t* out2) {
+    switch (simdLevel()) {
+        case SimdLevel::Avx512:
+        case SimdLevel::Avx2: mergeWordsPairAvx2(a1, na1, b1, nb1, out1, a2, na2, b2, nb2, out2); break;
+        case SimdLevel::Sse42: mergeWordsPairSse42(a1, na1, b1, nb1, out1, a2, na2, b2, nb2, out2); break;
+        default:
+            merge(a1, a1 + na1, b1, b1 + nb1, out1);
+            merge(a2, a2 + na2, b2, b2 + nb2, out2);
+    }
+}
+
+// ------------------------------
+// SIMD Leaf Sort for Records
+// ------------------------------
+// Word for a record: key in the high half, position in the low half. Positions are unique, so the
+// network's order is the stable one and the leaf can stand in for the insertion sort of stable sorts.
+inline int64_t simdLeafWord(int key, uint32_t position) {
+    return static_cast<int64_t>((static_cast<uint64_t>(static_cast<int64_t>(key)) << 32) | position);
+}
+
+// True if simdSortLeaf can take ranges of this record type and ordering: (int, int) records by .first
+template <typename RandomIt, typename Less>
+constexpr bool simdLeafSupported() {
+    return is_same<typename iterator_traits<RandomIt>::value_type, pair<int, int>>::value
+        && is_same<Less, KeyLess<FirstKey, less<>>>::value;
+}
+
+// Largest leaf simdSortLeaf takes: one vector network, or one compile-time network on the scalar level
+inline size_t simdLeafMax() { return simdLevel() == SimdLevel::Scalar ? SORTING_NETWORK_MAX : SIMD_LEAF_MAX; }
+
+// Stable sort of a leaf of at most simdLeafMax() records through one sorting network; returns false
+// (leaving the range untouched) when the records, the ordering or the length don't allow it
+template <typename RandomIt, typename Less>
+bool simdSortLeaf(RandomIt first, RandomIt last, Less) {
+    if constexpr (simdLeafSupported<RandomIt, Less>()) {
+        size_t n = last - first;
+        if (n > simdLeafMax()) return false;
+
+        // Presorted leaves are left alone: the network's cost does not drop for them, insertion sort's does
+        int64_t words[SIMD_LEAF_MAX];
+        pair<int, int> records[SIMD_LEAF_MAX];
+        bool sorted = true;
+        for (size_t i = 0; i < n; ++i) {
+            records[i] = first[i];
+            words[i] = simdLeafWord(records[i].first, static_cast<uint32_t>(i));
+            sorted &= i == 0 || records[i - 1].first <= records[i].first;
+        }
+        if (sorted) return true;
+        sortWords(words, n);
+        for (size_t i = 0; i < n; ++i) first[i] = records[static_cast<uint32_t>(words[i])];
+        return true;
+    } else {
+        return false;
+    }
+}
+
+// ------------------------------
+// Vectorized Partition
+// ------------------------------
+// Partitions (int, int) records by key around a pivot: keys below it (or not above it, with equalLeft)
+// move to the front. In-place scheme: the first and last blocks are set aside, which leaves a block of
+// free slots at each end; every step reads one block from the side with less free space and writes
+// its left records at the front cursor and its right records at the back cursor, so nothing unread is
+// overwritten. The set-aside blocks and the unaligned tail are placed last.
+
+using KeyRecord = pair<int, int>;
+
+// Lane threshold: a record goes left iff (key << 32) < (threshold << 32), threshold = pivot (+1 for equalLeft)
+inline int64_t partitionThreshold(int pivot, bool equalLeft) {
+    return static_cast<int64_t>(static_cast<uint64_t>(static_cast<int64_t>(pivot) + equalLeft) << 32);
+}
+
+// Places records one at a time, writing each to both cursors and advancing one of them: no branch on the
+// key. Needs a free slot at both cursors, which holds while the free slots equal the records still to place.
+SIMD_INLINE void placeRecordsBranchless(const KeyRecord* src, size_t n, int64_t threshold, KeyRecord*& left,
+                                        KeyRecord*& right) {
+    for (size_t i = 0; i < n; ++i) {
+        KeyRecord rec = src[i];
+        bool goesLeft = static_cast<int64_t>(static_cast<uint64_t>(static_cast<uint32_t>(rec.first)) << 32) < threshold;
+        *left = rec;
+        right[-1] = rec;
+        left += goesLeft;
+        right -= !goesLeft;
+    }
+}
+
+// Block steps: partition the B records at src into [left, left + B) and [right - B, right), then move the
+// cursors by the left and right counts. Both regions must be free; src may overlap them.
+struct ScalarPartitionBlock {
+    static const int B = 8;
+    void operator()(const KeyRecord* src, int64_t threshold, KeyRecord*& left, KeyRecord*& right) const {
+        KeyRecord block[B];
+        copy(src, src + B, block);
+        placeRecordsBranchless(block, B, threshold, left, right);
+    }
+};
+
+// AVX2: 4 records per register. The left lanes are permuted to the front, the right ones to the back, and the
+// one permuted register is stored at both cursors.
+struct Avx2PartitionBlock {
+    static const int B = 4;
+    __attribute__((target("avx2"))) void operator()(const KeyRecord* src, int64_t threshold, KeyRecord*& left,
+                                                    KeyRecord*& right) const {
+        // Dword indices that move the records of a 4-bit left mask first, keeping their order
+        alignas(32) static const int32_t permutations[16][8] = {
+            {0, 1, 2, 3, 4, 5, 6, 7}, {0, 1, 2, 3, 4, 5, 6, 7}, {2, 3, 0, 1, 4, 5, 6, 7}, {0, 1, 2, 3, 4, 5, 6, 7},
+            {4, 5, 0, 1, 2, 3, 6, 7}, {0, 1, 4, 5, 2, 3, 6, 7}, {2, 3, 4, 5, 0, 1, 6, 7}, {0, 1, 2, 3, 4, 5, 6, 7},
+            {6, 7, 0, 1, 2, 3, 4, 5}, {0, 1, 6, 7, 2, 3, 4, 5}, {2, 3, 6, 7, 0, 1, 4, 5}, {0, 1, 2, 3, 6, 7, 4, 5},
+            {4, 5, 6, 7, 0, 1, 2, 3}, {0, 1, 4, 5, 6, 7, 2, 3}, {2, 3, 4, 5, 6, 7, 0, 1}, {0, 1, 2, 3, 4, 5, 6, 7},
+        };
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        __m256i keys = _mm256_slli_epi64(v, 32);
+        __m256i goesLeft = _mm256_cmpgt_epi64(_mm256_set1_epi64x(threshold), keys);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(goesLeft));
+        __m256i permuted = _mm256_permutevar8x32_epi32(v, _mm256_load_si256(reinterpret_cast<const __m256i*>(permutations[mask])));
+        int leftCount = __builtin_popcount(mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(left), permuted);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(right - B), permuted);
+        left += leftCount;
+        right -= B - leftCount;
+    }
+};
+
+// AVX-512: 8 records per register, split with two compress stores
+struct Avx512PartitionBlock {
+    static const int B = 8;
+    __attribute__((target("avx512f"))) void operator()(const KeyRecord* src, int64_t threshold, KeyRecord*& left,
+                                                       KeyRecord*& right) const {
+        __m512i v = _mm512_loadu_si512(src);
+        __mmask8 goesLeft = _mm512_cmplt_epi64_mask(_mm512_maskz_slli_epi64(0xFF, v, 32), _mm512_set1_epi64(threshold));
+        int leftCount = __builtin_popcount(goesLeft);
+        _mm512_mask_compressstoreu_epi64(left, goesLeft, v);
+        _mm512_mask_compressstoreu_epi64(right - (B - leftCount), static_cast<__mmask8>(~goesLeft), v);
+        left += leftCount;
+        right -= B - leftCount;
+    }
+};
+
+template <typename Block>
+SIMD_INLINE KeyRecord* partitionRecordsWith(KeyRecord* first, KeyRecord* last, int64_t threshold, Block block) {
+    const ptrdiff_t B = Block::B;
+    KeyRecord pending[3 * Block::B];
+    size_t pendingCount = 0;
+    KeyRecord *left = first, *right = last;
+    if (last - first >= 2 * B) {
+        copy(first, first + B, pending);
+        copy(last - B, last, pending + B);
+        pendingCount = 2 * B;
+        KeyRecord *readLeft = first + B, *readRight = last - B;
+        while (readRight - readLeft >= B) {
+            if (readLeft - left <= right - readRight) {
+                block(readLeft, threshold, left, right);
+                readLeft += B;
+            } else {
+                readRight -= B;
+                block(readRight, threshold, left, right);
+            }
+        }
+        first = readLeft;
+        last = readRight;
+    }
+    copy(first, last, pending + pendingCount);
+    placeRecordsBranchless(pending, pendingCount + (last - first), threshold, left, right);
+    return left;
+}
+
+__attribute__((target("avx512f"))) inline KeyRecord* partitionRecordsAvx512(KeyRecord* first, KeyRecord* last,
+                                                                            int64_t threshold) {
+    return partitionRecordsWith(first, last, threshold, Avx512PartitionBlock{});
+}
+__attribute__((target("avx2"))) inline KeyRecord* partitionRecordsAvx2(KeyRecord* first, KeyRecord* last,
+                                                                       int64_t threshold) {
+    return partitionRecordsWith(first, last, threshold, Avx2PartitionBlock{});
+}
+
+// Moves records with key < pivot (key <= pivot if equalLeft) to the front of [first, last) and returns the
+// boundary. AVX-512 compress stores, else AVX2 permutes, else the branchless scalar block partition.
+inline KeyRecord* partitionRecords(KeyRecord* first, KeyRecord* last, int pivot, bool equalLeft) {
+    if (equalLeft && pivot == INT_MAX) return last;
+    int64_t threshold = partitionThreshold(pivot, equalLeft);
+    switch (simdLevel()) {
+        case SimdLevel::Avx512: return partitionRecordsAvx512(first, last, threshold);
+        case SimdLevel::Avx2: return partitionRecordsAvx2(first, last, threshold);
+        default: return partitionRecordsWith(first, last, threshold, ScalarPartitionBlock{});
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+// ------------------------------
+// Algorithm Registry
+// ------------------------------
+// Harness-facing entry point of one sort on (value, original index) records
+using SortFunction = function<void(vector<pair<int, int>>&)>;
+
+// The same sort on a record range in place, e.g. a mapped dataset; empty for sorts that only take a vector
+using RangeSortFunction = function<void(pair<int, int>*, pair<int, int>*)>;
+
+struct SortEntry {
+    string name;
+    SortFunction func;
+    bool quadratic; // O(n^2) sorts: the time budget extrapolates their cost quadratically
+    double scratch; // Most heap the sort takes beyond its input, per input byte; the external sort sizes runs by it
+    RangeSortFunction range;
+};
+
+// Every registered sort, in registration (include) order
+inline vector<SortEntry>& sortRegistry() {
+    static vector<SortEntry> entries;
+    return entries;
+}
+
+struct SortRegistrar {
+    SortRegistrar(string name, double scratch, SortFunction func, bool quadratic = false) {
+        sortRegistry().push_back({std::move(name), std::move(func), quadratic, scratch, {}});
+    }
+    SortRegistrar(string name, double scratch, SortFunction func, RangeSortFunction range) {
+        sortRegistry().push_back({std::move(name), std::move(func), false, scratch, std::move(range)});
+    }
+};
+
+// Registers a sort with the harness from the header that defines it; id must be unique (e.g. the function name).
+// scratch is the sort's peak heap over its input bytes at 1M records, rounded up (quadratic sorts are in place).
+// inline variables keep one registration per program however many translation units include the header.
+#define REGISTER_SORT(id, name, scratch, ...) \
+    inline const SortRegistrar sortRegistrar_##id{name, scratch, __VA_ARGS__}
+#define REGISTER_QUADRATIC_SORT(id, name, ...) \
+    inline const SortRegistrar sortRegistrar_##id{name, 0, __VA_ARGS__, true}
+// Registers a sort that has an iterator form, sort(first, last): the harness gets both the vector entry
+// point and a range one, so it can sort a mapped dataset where it lies instead of copying it into a vector.
+#define REGISTER_RANGE_SORT(id, name, scratch, sort) \
+    inline const SortRegistrar sortRegistrar_##id{name, scratch, \
+        [](vector<pair<int, int>>& arr) { sort(arr.begin(), arr.end()); }, \
+        RangeSortFunction([](pair<int, int>* first, pair<int, int>* last) { sort(first, last); })}
@@ -0,0 +1,41 @@
+#pragma once
+#include <functional>
+#include <iterator>
+#include <utility>
+
+using namespace std;
+
+// ------------------------------
+// Key Extractors
+// ------------------------------
+
+// Default key for (value, original index) records: only .first is compared
+struct FirstKey {
+    template <typename T>
+    constexpr const auto& operator()(const T& rec) const { return rec.first; }
+};
+
+// Key for plain scalar records (e.g. vector<long long>, vector<string>)
+struct IdentityKey {
+    template <typename T>
+    constexpr const T& operator()(const T& rec) const { return rec; }
+};
+
+// ------------------------------
+// Record Comparator
+// ------------------------------
+
+// Binds a key extractor and a key comparator into one "record a < record b" predicate
+template <typename KeyFn, typename Compare>
+struct KeyLess {
+    KeyFn key;
+    Compare comp;
+
+    template <typename T, typename U>
+    constexpr bool operator()(const T& a, const U& b) const { return comp(key(a), key(b)); }
+};
+
+template <typename KeyFn, typename Compare>
+constexpr KeyLess<KeyFn, Compare> makeKeyLess(KeyFn key, Compare comp) {
+    return KeyLess<KeyFn, Compare>{key, comp};
+}
@@ -9,21 +9,36 @@
 #include <map>
 #include <unordered_set>
 #include <sstream>
-#include <sys/resource.h>
 #include <algorithm>
 
-using namespace std;
+#include "adaptive_sorts.h"
+#include "alloc_counter.h"
+#include "basic_sorts.h"
+#include "benchmark.h"
+#include "dataset_file.h"
+#include "external_sort.h"
+#include "incremental_sort.h"
+#include "input_generator.h"
+#include "packed_sort.h"
+#include "perf_counters.h"
+#include "result_writer.h"
+#include "selection.h"
+#include "verify.h"
 
-extern ofstream csvOut; // Global CSV output stream
+using namespace std;
 
-// Check if the array is sorted
-inline bool isSorted(const vector<pair<int, int>>& arr) {
-    for (size_t i = 1; i < arr.size(); ++i) {
-        if (arr[i - 1].first > arr[i].first) return false;
-    }
-    return true;
+// ------------------------------
+// Inversion Analysis (opt-in)
+// ------------------------------
+// O(n log n) with two full copies per call, so it stays out of runs unless asked for (--inversions)
+inline bool& inversionAnalysisSetting() {
+    static bool enabled = false;
+    return enabled;
 }
 
+inline bool inversionAnalysisEnabled() { return inversionAnalysisSetting(); }
+inline void setInversionAnalysisEnabled(bool enabled) { inversionAnalysisSetting() = enabled; }
+
 // Merge step with inversion counting (used in Merge Sort)
 inline long long mergeAndCount(vector<pair<int, int>>& arr, vector<pair<int, int>>& temp, int left, int mid, int right) {
     long long inv_count = 0;
@@ -60,160 +75,757 @@ inline long long countInversions(const vector<pair<int, int>>& original) {
     return countInversionsUtil(arr, temp, 0, arr.size() - 1);
 }
 
-// Measure execution time in seconds
-template <typename Func>
-double measureExecutionTime(Func sortFunc, vector<pair<int, int>>& data) {
+// Counter line for the console; silent when nothing was counted
+inline void printPerfSample(const PerfSample& perf) {
+    string line;
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        if (!perf.available[e]) continue;
+        line += (line.empty() ? "" : ", ") + perfEventNames()[e] + "=" + to_string(perf.values[e]);
+    }
+    if (!line.empty()) cout << "Counters: " << line << "\n";
+}
+
+// Fills the counter columns of a row from a sample; events that weren't counted stay "-"
+inline void setPerfColumns(ResultRow& row, const PerfSample& perf) {
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e)
+        if (perf.available[e]) row.set(perfEventNames()[e], perf.values[e]);
+}
+
+// Heap usage line for the console
+inline void printAllocationStats(const AllocationStats& heap) {
+    cout << "Heap: " << heap.allocations << " allocations, " << heap.bytes << " bytes allocated, "
+         << heap.peakBytes << " bytes peak\n";
+}
+
+// The columns every benchmarked row shares: the cell, the timing summary, heap, counters and the sort status.
+// Callers whose check covers stability add the Stability columns themselves.
+template <typename T>
+ResultRow benchmarkRow(const string& name, int size, const string& inputType, uint64_t seed, size_t recordBytes,
+                       const BenchmarkResult<T>& bench, const VerifyResult& verify) {
+    const BenchmarkStats& t = bench.time;
+    ResultRow row;
+    row.set("Algorithm", name);
+    row.set("Size", size);
+    row.set("InputType", inputType);
+    row.set("Seed", seed);
+    row.set("RecordBytes", recordBytes);
+    row.set("Time", t.median);
+    row.set("Runs", t.runs);
+    row.set("MinTime", t.min);
+    row.set("P90Time", t.p90);
+    row.set("P99Time", t.p99);
+    row.set("StdDevTime", t.stddev);
+    row.set("Allocations", bench.heap.allocations);
+    row.set("AllocatedBytes", bench.heap.bytes);
+    row.set("PeakHeapBytes", bench.heap.peakBytes);
+    row.set("SortStatus", sortStatusOf(verify));
+    setPerfColumns(row, bench.perf);
+    return row;
+}
+
+// Prints a benchmarked sort's summary and writes its CSV row; returns the median time.
+// inversions() gives the (before, after) inversion counts and is only called when that analysis is on.
+inline double reportExperiment(const string& name, const BenchmarkResult<pair<int, int>>& bench,
+                               const VerifyResult& verify, const string& inputType, int size, uint64_t seed,
+                               const function<pair<long long, long long>()>& inversions) {
+    const BenchmarkStats& t = bench.time;
+    cout << "\n[" << name << "]\n";
+    cout << "Median Time: " << t.median << " sec (" << t.runs << " runs, min " << t.min << ", p90 " << t.p90
+         << ", p99 " << t.p99 << ", stddev " << t.stddev << ")\n";
+    printAllocationStats(bench.heap);
+    printPerfSample(bench.perf);
+    cout << "Result: " << sortStatusOf(verify) << ", " << (verify.stable() ? "stable" : "not stable") << "\n";
+
+    ResultRow row = benchmarkRow(name, size, inputType, seed, sizeof(pair<int, int>), bench, verify);
+    row.set("Stability", verify.stable() ? "Stable" : "Not Stable");
+    row.set("StablePercent", verify.stablePercent());
+    if (inversionAnalysisEnabled()) {
+        auto [beforeInv, afterInv] = inversions();
+        cout << "Inversion Count (before → after): " << beforeInv << " → " << afterInv << "\n";
+        row.set("InversionBefore", beforeInv);
+        row.set("InversionAfter", afterInv);
+    }
+    resultWriter().write(row);
+    return t.median;
+}
+
+// Benchmark one sort on one input cell and write its CSV row; returns the median time
+inline double runExperiment(const string& name, function<void(vector<pair<int, int>>&)> sortFunc,
+                          const vector<pair<int, int>>& input, const string& inputType, int size, uint64_t seed) {
+    MultisetHash inputHash = multisetHash(input);
+    BenchmarkResult bench = runBenchmark(sortFunc, input);
+
+    // Linear check of the last run's output: order, same records, stability
+    VerifyResult verify = verifySortedOutput(bench.output, inputHash);
+    return reportExperiment(name, bench, verify, inputType, size, seed, [&] {
+        return make_pair(countInversions(input), countInversions(bench.output));
+    });
+}
+
+// runExperiment on a mapped dataset, sorted where it lies through the sort's range entry point: each run
+// starts from the file's order again, and no copy of the records is made
+inline double runExperimentInPlace(const string& name, const RangeSortFunction& sortFunc, MappedDataset& dataset,
+                                   const MultisetHash& inputHash, const string& inputType, int size, uint64_t seed) {
+    BenchmarkResult bench = runBenchmarkInPlace(sortFunc, dataset.begin(), dataset.end(), [&] { dataset.restore(); });
+    VerifyResult verify = verifySortedOutput(dataset.begin(), dataset.end(), inputHash);
+    return reportExperiment(name, bench, verify, inputType, size, seed, [&] {
+        long long afterInv = countInversions(vector<pair<int, int>>(dataset.begin(), dataset.end()));
+        dataset.restore();
+        return make_pair(countInversions(vector<pair<int, int>>(dataset.begin(), dataset.end())), afterInv);
+    });
+}
+
+// Sort the dataset file at inputPath with externalSort, the entry's sort forming the runs, then verify the
+// mapped output in one pass. Runs once: repeats would mostly measure the page cache.
+inline double runExternalExperiment(const SortEntry& entry, const string& inputPath, const MultisetHash& inputHash,
+                                    const string& inputType, size_t size, uint64_t seed, ExternalSortConfig config) {
+    const string& name = entry.name;
+    string outputPath = externalTempDir(config.tempDir) + "/extsort." + to_string(getpid()) + ".output";
+    cout << "\n[" << name << ", external]\n";
+
+    config.runSort = entry.func;
+    config.runScratch = entry.scratch;
+    ExternalSortStats stats;
+    string error;
+    AllocationTracker heapTracker;
     auto start = chrono::high_resolution_clock::now();
-    sortFunc(data);
-    auto end = chrono::high_resolution_clock::now();
-    return chrono::duration<double>(end - start).count();
-}
-
-// Estimate memory usage of the algorithm
-inline size_t estimateMemoryUsage(const vector<pair<int, int>>& data, const string& algorithm) {
-    size_t base = data.capacity() * sizeof(pair<int, int>);
-    static unordered_map<string, double> overhead = {
-        {"Bubble Sort", 0.0}, {"Insertion Sort", 0.0}, {"Selection Sort", 0.0},
-        {"Cocktail Shaker Sort", 0.0}, {"Comb Sort", 0.0},
-        {"Quick Sort", 0.01}, {"Merge Sort", 1.0}, {"Heap Sort", 0.0},
-        {"Tournament Sort", 4.0}, {"Library Sort", 1.0},
-        {"Tim Sort", 1.0}, {"Introsort", 0.5}
-    };
-    return base + static_cast<size_t>(base * overhead[algorithm]);
+    bool ok = externalSort(inputPath, outputPath, config, stats, error);
+    double time = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    AllocationStats heap = heapTracker.stop();
+
+    VerifyResult verify;
+    if (ok) {
+        MappedDataset output;
+        ok = output.open(outputPath, error);
+        if (ok) {
+            output.adviseSequential();
+            OutputChecker checker;
+            for (const Record& rec : output) checker.add(rec);
+            verify = checker.finish(inputHash);
+        }
+    }
+    unlink(outputPath.c_str());
+
+    ResultRow row;
+    row.set("Algorithm", name);
+    row.set("Size", size);
+    row.set("InputType", inputType);
+    row.set("Seed", seed);
+    if (!ok) {
+        cout << "Error: " << error << "\n";
+        row.set("SortStatus", "Failed");
+        resultWriter().write(row);
+        return 0;
+    }
+
+    cout << "Time: " << time << " sec (runs " << stats.runPhaseTime << " sec at " << stats.runPhaseMBps()
+         << " MB/s, merge " << stats.mergePhaseTime << " sec at " << stats.mergePhaseMBps() << " MB/s)\n";
+    cout << "I/O: " << stats.runs << " runs, " << stats.mergePasses << " merge passes, " << stats.bytesRead()
+         << " bytes read, " << stats.bytesWritten() << " bytes written\n";
+    printAllocationStats(heap);
+    cout << "Result: " << sortStatusOf(verify) << ", " << (verify.stable() ? "stable" : "not stable") << "\n";
+
+    row.set("RecordBytes", sizeof(Record));
+    row.set("Time", time);
+    row.set("Runs", 1);
+    row.set("Allocations", heap.allocations);
+    row.set("AllocatedBytes", heap.bytes);
+    row.set("PeakHeapBytes", heap.peakBytes);
+    row.set("SortStatus", sortStatusOf(verify));
+    row.set("Stability", verify.stable() ? "Stable" : "Not Stable");
+    row.set("StablePercent", verify.stablePercent());
+    row.set("BytesRead", stats.bytesRead());
+    row.set("BytesWritten", stats.bytesWritten());
+    row.set("MergePasses", stats.mergePasses);
+    row.set("RunPhaseTime", stats.runPhaseTime);
+    row.set("RunPhaseMBps", stats.runPhaseMBps());
+    row.set("MergePhaseTime", stats.mergePhaseTime);
+    row.set("MergePhaseMBps", stats.mergePhaseMBps());
+    resultWriter().write(row);
+    return time;
 }
 
-// Get peak resident set size (VmHWM) in KB
-inline size_t getPeakRSS() {
-    ifstream status("/proc/self/status");
-    string line;
-    while (getline(status, line)) {
-        if (line.rfind("VmHWM:", 0) == 0) {
-            istringstream iss(line);
-            string key, unit;
-            size_t value;
-            iss >> key >> value >> unit;
-            return value;
+// Print speedup of each listed algorithm against each baseline, from one input cell's times
+inline void reportSpeedup(const map<string, double>& times, const vector<string>& algorithms,
+                          const vector<string>& baselines) {
+    for (const auto& name : algorithms) {
+        auto it = times.find(name);
+        if (it == times.end() || it->second <= 0) continue;
+        for (const auto& base : baselines) {
+            auto bt = times.find(base);
+            if (bt == times.end()) continue;
+            cout << "Speedup [" << name << " vs " << base << "]: " << bt->second / it->second << "x\n";
         }
     }
-    return 0;
 }
 
-// Run sorting experiment (10 runs average)
-inline void runExperiment(const string& name, function<void(vector<pair<int, int>>&)> sortFunc,
-                          const vector<pair<int, int>>& input, const string& inputType, int size) {
-    double totalTime = 0;
-    const int runs = 10;
-    vector<pair<int, int>> result;
+// Run stability test multiple times; StablePercent is the share of adjacent equal-key pairs left in input order
+inline void runStabilityTest(const string& name, function<void(vector<pair<int, int>>&)> sortFunc, const vector<int>& input,
+                             uint64_t seed, int trials = 10) {
+    double totalPercent = 0.0;
+    bool allStable = true;
 
-    long long beforeInv = countInversions(input); // Inversions before sort
-    size_t peakBefore = getPeakRSS();             // Memory before sort
+    vector<pair<int, int>> data(input.size());
+    for (int t = 0; t < trials; ++t) {
+        for (size_t i = 0; i < input.size(); ++i)
+            data[i] = {input[i], static_cast<int>(i)}; // Second = unique ID
+        MultisetHash inputHash = multisetHash(data);
 
-    for (int i = 0; i < runs; ++i) {
-        vector<pair<int, int>> copy = input;
-        totalTime += measureExecutionTime(sortFunc, copy);
-        if (i == 0) result = copy; // Save first result
+        sortFunc(data);
+        VerifyResult result = verifySortedOutput(data, inputHash);
+        totalPercent += result.stablePercent();
+        if (!result.stable()) allStable = false;
     }
 
-    size_t peakAfter = getPeakRSS();
-    size_t peakDiff = (peakAfter > peakBefore) ? (peakAfter - peakBefore) : 0;
-    double avgTime = totalTime / runs;
-    size_t memEstimate = estimateMemoryUsage(input, name);
-    long long afterInv = countInversions(result);
-    string sortStatus = isSorted(result) ? "Sorted" : "Sort Failed";
+    double avgPercent = totalPercent / trials;
+    cout << "Stability: " << (allStable ? "Stable" : "Not Stable") << " (" << avgPercent << "%)\n";
+
+    ResultRow row;
+    row.set("Algorithm", name);
+    row.set("Size", input.size());
+    row.set("InputType", "StabilityTest");
+    row.set("Seed", seed);
+    row.set("RecordBytes", sizeof(pair<int, int>));
+    row.set("Stability", allStable ? "Stable" : "Not Stable");
+    row.set("StablePercent", avgPercent);
+    resultWriter().write(row);
+}
+
+// Generate input with many duplicates: size / mod copies of each value, shuffled by the seed
+inline vector<int> generateDuplicateRichInput(int size, uint64_t seed, int mod = 10) {
+    vector<int> result(size);
+    for (int i = 0; i < size; ++i) result[i] = i % mod;
+    for (int i = size - 1; i > 0; --i) swap(result[i], result[randomAt(seed, i) % (i + 1)]);
+    return result;
+}
+
+// ------------------------------
+// Record Layout Comparison (AoS vs SoA)
+// ------------------------------
+// A Bytes-byte record: the (key, original index) pair followed by an opaque payload
+template <size_t Bytes>
+struct WideRecord {
+    static_assert(Bytes > sizeof(pair<int, int>), "a wide record carries a payload");
+    int first = 0;
+    int second = 0;
+    char payload[Bytes - sizeof(pair<int, int>)];
+};
+
+// Record sizes the layout comparison is compiled for
+inline const vector<size_t>& layoutRecordSizes() {
+    static const vector<size_t> sizes = {16, 32, 64, 128, 256, 512};
+    return sizes;
+}
+
+// Engines with both an AoS form (move whole records) and a packed-word form
+inline const vector<string>& layoutEngines() {
+    static const vector<string> engines = {"Intro Sort", "Merge Sort", "LSD Radix Sort"};
+    return engines;
+}
+
+template <typename T>
+void sortRecordsWith(const string& engine, vector<T>& v) {
+    if (engine == "Intro Sort") IntroSort(v.begin(), v.end());
+    else if (engine == "Merge Sort") MergeSort(v.begin(), v.end());
+    else LSDRadixSort(v.begin(), v.end());
+}
+
+inline void sortPackedWith(const string& engine, vector<PackedRecord>& w) {
+    if (engine == "Intro Sort") IntroSort(w.begin(), w.end(), IdentityKey{});
+    else if (engine == "Merge Sort") MergeSort(w.begin(), w.end(), IdentityKey{});
+    else LSDRadixSort(w.begin(), w.end(), PackedRadixKey{});
+}
+
+// One engine on one input with Bytes-byte records, laid out two ways: AoS sorts the records themselves;
+// SoA sorts packed key + index words and then gathers the records once with applyPermutation.
+// Writes a row per layout; returns the AoS / SoA median time ratio.
+template <size_t Bytes>
+double runLayoutComparisonAs(const string& engine, const vector<pair<int, int>>& input, const string& inputType,
+                             int size, uint64_t seed) {
+    vector<WideRecord<Bytes>> records(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        records[i].first = input[i].first;
+        records[i].second = input[i].second;
+        fill(begin(records[i].payload), end(records[i].payload), static_cast<char>(input[i].second));
+    }
+    MultisetHash inputHash = multisetHash(input);
+
+    auto aos = [&](vector<WideRecord<Bytes>>& v) { sortRecordsWith(engine, v); };
+    auto soa = [&](vector<WideRecord<Bytes>>& v) {
+        vector<PackedRecord> words(v.size());
+        for (size_t i = 0; i < v.size(); ++i) words[i] = packRecord(v[i].first, static_cast<uint32_t>(i));
+        sortPackedWith(engine, words);
+        applyPermutation(v, words);
+    };
+
+    double medians[2];
+    const char* layouts[2] = {"AoS", "SoA"};
+    for (int l = 0; l < 2; ++l) {
+        auto bench = l == 0 ? runBenchmark(aos, records) : runBenchmark(soa, records);
+        const BenchmarkStats& t = bench.time;
+
+        // Keys and ids must still pair up, and the payload must have travelled with its record
+        vector<pair<int, int>> keys(bench.output.size());
+        bool payloadIntact = true;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            const auto& rec = bench.output[i];
+            keys[i] = {rec.first, rec.second};
+            payloadIntact = payloadIntact && rec.payload[0] == static_cast<char>(rec.second);
+        }
+        VerifyResult verify = verifySortedOutput(keys, inputHash);
+        verify.permutation = verify.permutation && payloadIntact;
+
+        string name = engine + " (" + layouts[l] + ")";
+        cout << "\n[" << name << ", " << Bytes << "-byte records]\n";
+        cout << "Median Time: " << t.median << " sec (" << t.runs << " runs, min " << t.min << ", "
+             << Bytes * input.size() / t.median / 1e6 << " MB/s)\n";
+        printAllocationStats(bench.heap);
+        cout << "Result: " << sortStatusOf(verify) << ", " << (verify.stable() ? "stable" : "not stable") << "\n";
+
+        ResultRow row = benchmarkRow(name, size, inputType, seed, Bytes, bench, verify);
+        row.set("Stability", verify.stable() ? "Stable" : "Not Stable");
+        row.set("StablePercent", verify.stablePercent());
+        resultWriter().write(row);
+        medians[l] = t.median;
+    }
+    cout << "Speedup [SoA vs AoS]: " << medians[0] / medians[1] << "x\n";
+    return medians[0] / medians[1];
+}
+
+// Dispatches a runtime record size to its compiled instance; sizes outside layoutRecordSizes() are skipped
+inline void runLayoutComparison(const string& engine, size_t recordBytes, const vector<pair<int, int>>& input,
+                                const string& inputType, int size, uint64_t seed) {
+    switch (recordBytes) {
+        case 16: runLayoutComparisonAs<16>(engine, input, inputType, size, seed); break;
+        case 32: runLayoutComparisonAs<32>(engine, input, inputType, size, seed); break;
+        case 64: runLayoutComparisonAs<64>(engine, input, inputType, size, seed); break;
+        case 128: runLayoutComparisonAs<128>(engine, input, inputType, size, seed); break;
+        case 256: runLayoutComparisonAs<256>(engine, input, inputType, size, seed); break;
+        case 512: runLayoutComparisonAs<512>(engine, input, inputType, size, seed); break;
+        default: break;
+    }
+}
+
+// ------------------------------
+// Small-Array Batches
+// ------------------------------
+// Small-range engines, each a plain function so the batch loop pays the same indirect call for all of them
+using SmallArraySort = void (*)(pair<int, int>*, pair<int, int>*);
+
+inline const vector<pair<string, SmallArraySort>>& smallArrayEngines() {
+    using Record = pair<int, int>;
+    static const vector<pair<string, SmallArraySort>> engines = {
+        {"Sorting Network", [](Record* f, Record* l) { networkSort(f, l, makeKeyLess(FirstKey{}, less<>{})); }},
+        {"SIMD Leaf", [](Record* f, Record* l) { simdSortLeaf(f, l, makeKeyLess(FirstKey{}, less<>{})); }},
+        {"Insertion Sort", [](Record* f, Record* l) { insertionSortRange(f, l, makeKeyLess(FirstKey{}, less<>{})); }},
+        {"Intro Sort", [](Record* f, Record* l) { IntroSort(f, l); }},
+        {"Quick Sort", [](Record* f, Record* l) { QuickSort(f, l); }},
+        {"Merge Sort", [](Record* f, Record* l) { MergeSort(f, l); }},
+    };
+    return engines;
+}
 
+// Cuts the input into independent arrays of `length` records (a shorter tail is left alone) and sorts each
+// with the engine. Writes a row named "<engine> (<length>-element arrays)"; Size stays the total record count.
+inline double runSmallArrayBatch(const string& engine, SmallArraySort sortArray, size_t length,
+                                 const vector<pair<int, int>>& input, const string& inputType, int size, uint64_t seed) {
+    size_t arrays = input.size() / length;
+    auto batch = [&](vector<pair<int, int>>& v) {
+        for (size_t a = 0; a < arrays; ++a) sortArray(v.data() + a * length, v.data() + (a + 1) * length);
+    };
+    auto bench = runBenchmark(batch, input);
+    const BenchmarkStats& t = bench.time;
+
+    // Each array must be sorted on its own; the tail must be untouched
+    VerifyResult verify;
+    verify.permutation = multisetHash(bench.output) == multisetHash(input)
+                      && equal(input.begin() + arrays * length, input.end(), bench.output.begin() + arrays * length);
+    for (size_t a = 0; a < arrays && verify.sorted; ++a) {
+        auto first = bench.output.begin() + a * length;
+        verify.sorted = is_sorted(first, first + length,
+                                  [](const pair<int, int>& x, const pair<int, int>& y) { return x.first < y.first; });
+    }
+
+    string name = engine + " (" + to_string(length) + "-element arrays)";
     cout << "\n[" << name << "]\n";
-    cout << "Average Time: " << avgTime << " sec\n";
-    cout << "Inversion Count (before → after): " << beforeInv << " → " << afterInv << "\n";
-    cout << "Actual Peak Memory Increase (VmHWM): " << peakDiff << " KB\n";
-
-    csvOut << name << "," << size << "," << inputType << "," << avgTime << "," << memEstimate
-           << "," << peakDiff << "," << beforeInv << "," << afterInv << "," << sortStatus << ",,-\n";
-}
-
-// Run a single experiment (one trial)
-inline void runSingleExperiment(const string& name, function<void(vector<pair<int, int>>&)> sortFunc,
-                                const vector<pair<int, int>>& input, const string& inputType, int size) {
-    vector<pair<int, int>> copy = input;
-    size_t peakBefore = getPeakRSS();
-    long long beforeInv = countInversions(copy);
-    double time = measureExecutionTime(sortFunc, copy);
-    long long afterInv = countInversions(copy);
-    size_t peakAfter = getPeakRSS();
-    size_t peakDiff = (peakAfter > peakBefore) ? (peakAfter - peakBefore) : 0;
-    size_t memEstimate = estimateMemoryUsage(input, name);
-    string sortStatus = isSorted(copy) ? "Sorted" : "Sort Failed";
+    cout << "Median Time: " << t.median << " sec (" << t.runs << " runs, min " << t.min << ", "
+         << (arrays ? t.median / arrays * 1e9 : 0) << " ns per array)\n";
+    cout << "Result: " << sortStatusOf(verify) << "\n";
+
+    ResultRow row = benchmarkRow(name, size, inputType, seed, sizeof(pair<int, int>), bench, verify);
+    resultWriter().write(row);
+    return t.median;
+}
+
+// ------------------------------
+// Selection Benchmarks
+// ------------------------------
+const size_t SELECT_MEDIAN = 0;          // --top-k value that asks for the median instead of a top-k prefix
+const size_t TOP_K_STREAM_BATCH = 4096;  // Records per push when the input is fed to TopKStream
+
+// Engines that answer a selection question, the first being the full sort it is measured against
+inline const vector<string>& selectionEngines() {
+    static const vector<string> engines = {"Intro Sort + Slice", "Introselect", "Floyd-Rivest", "Partial Sort (Heap)",
+                                           "Top-k Stream"};
+    return engines;
+}
 
+// Leaves the k smallest records of v in v[0, k): sorted if sortPrefix, else with v[k - 1] the k-th smallest
+inline void selectWith(const string& engine, vector<pair<int, int>>& v, size_t k, bool sortPrefix) {
+    auto first = v.begin(), kth = v.begin() + (k - 1);
+    if (engine == "Intro Sort + Slice") {
+        IntroSort(first, v.end());
+    } else if (engine == "Introselect" || engine == "Floyd-Rivest") {
+        if (engine == "Introselect") NthElement(first, kth, v.end());
+        else FloydRivestNthElement(first, kth, v.end());
+        if (sortPrefix) IntroSort(first, kth);
+    } else if (engine == "Partial Sort (Heap)") {
+        PartialSort(first, kth + 1, v.end());
+    } else {
+        TopKStream<pair<int, int>> stream(k);
+        for (size_t i = 0; i < v.size(); i += TOP_K_STREAM_BATCH)
+            stream.push(first + i, first + min(v.size(), i + TOP_K_STREAM_BATCH));
+        vector<pair<int, int>> top = stream.sorted();
+        copy(top.begin(), top.end(), first);
+    }
+}
+
+// One engine answering "the k smallest records, sorted" (topK > 0) or "the median" (topK == SELECT_MEDIAN)
+// on one input. Writes a row named "<engine> (top <k>)" or "<engine> (median)"; returns the median time.
+inline double runSelectionExperiment(const string& engine, size_t topK, const vector<pair<int, int>>& input,
+                                     const string& inputType, int size, uint64_t seed) {
+    if (input.empty()) return 0;
+    bool median = topK == SELECT_MEDIAN;
+    size_t k = median ? input.size() / 2 + 1 : min(topK, input.size());
+    auto select = [&](vector<pair<int, int>>& v) { selectWith(engine, v, k, !median); };
+    auto bench = runBenchmark(select, input);
+    const BenchmarkStats& t = bench.time;
+
+    // The prefix must hold the k smallest keys (in order for top-k), each an input record, none twice
+    vector<int> expected(input.size());
+    for (size_t i = 0; i < input.size(); ++i) expected[i] = input[i].first;
+    nth_element(expected.begin(), expected.begin() + (k - 1), expected.end());
+    sort(expected.begin(), expected.begin() + k);
+    vector<int> keys(k);
+    vector<bool> seen(input.size());
+    VerifyResult verify;
+    for (size_t i = 0; i < k; ++i) {
+        const auto& rec = bench.output[i];
+        size_t id = static_cast<size_t>(rec.second);
+        bool valid = id < input.size() && input[id] == rec && !seen[id];
+        verify.permutation = verify.permutation && valid;
+        if (valid) seen[id] = true;
+        keys[i] = rec.first;
+    }
+    if (median) {
+        verify.sorted = keys[k - 1] == expected[k - 1];
+        sort(keys.begin(), keys.end());
+    }
+    verify.sorted = verify.sorted && equal(keys.begin(), keys.end(), expected.begin());
+
+    string name = engine + (median ? string(" (median)") : " (top " + to_string(k) + ")");
     cout << "\n[" << name << "]\n";
-    cout << "Time: " << time << " sec\n";
-    cout << "Inversion Count (before → after): " << beforeInv << " → " << afterInv << "\n";
-    cout << "Actual Peak Memory Increase (VmHWM): " << peakDiff << " KB\n";
+    cout << "Median Time: " << t.median << " sec (" << t.runs << " runs, min " << t.min << ")\n";
+    printAllocationStats(bench.heap);
+    cout << "Result: " << sortStatusOf(verify) << "\n";
 
-    csvOut << name << "," << size << "," << inputType << "," << time << "," << memEstimate
-           << "," << peakDiff << "," << beforeInv << "," << afterInv << "," << sortStatus << ",,-\n";
+    ResultRow row = benchmarkRow(name, size, inputType, seed, sizeof(pair<int, int>), bench, verify);
+    resultWriter().write(row);
+    return t.median;
 }
 
-// Structure for stability test result
-struct StabilityResult {
-    bool stable;
-    double ratio;
-};
+// ------------------------------
+// Incremental Ingest Benchmarks
+// ------------------------------
+const size_t INGEST_QUERIES_PER_BATCH = 4; // Range queries answered after each ingested batch
+const double INGEST_QUERY_SPAN = 0.001;    // Share of the input's key range one query covers
 
-// Check stability of sorting algorithm
-inline StabilityResult checkStability(function<void(vector<pair<int, int>>&)> sortFunc, const vector<pair<int, int>>& original) {
-    vector<pair<int, int>> sorted = original;
-    sortFunc(sorted);
-
-    map<int, vector<int>> before, after;
-    for (const auto& p : original) before[p.first].push_back(p.second);
-    for (const auto& p : sorted)   after[p.first].push_back(p.second);
-
-    long long total = 0, preserved = 0;
-    for (const auto& [val, bvec] : before) {
-        const auto& avec = after[val];
-        for (size_t i = 0; i < bvec.size(); ++i)
-            for (size_t j = i + 1; j < bvec.size(); ++j) {
-                if ((bvec[i] < bvec[j]) == (avec[i] < avec[j])) preserved++;
-                total++;
+// Engines that keep ingested records queryable: re-sorting everything after each batch, or the run log
+inline const vector<string>& ingestEngines() {
+    static const vector<string> engines = {"Re-sort (Intro Sort)", "Re-sort (Tim Sort)", "Sorted Run Log"};
+    return engines;
+}
+
+// Key ranges [lo, hi) for the queries, INGEST_QUERIES_PER_BATCH after each batch, spread over the keys
+inline vector<pair<int, int>> ingestQueries(const vector<pair<int, int>>& input, size_t batches, uint64_t seed) {
+    vector<pair<int, int>> queries;
+    if (input.empty()) return queries;
+    auto [lo, hi] = minmax_element(input.begin(), input.end());
+    long long range = static_cast<long long>(hi->first) - lo->first + 1;
+    long long span = max<long long>(1, static_cast<long long>(range * INGEST_QUERY_SPAN));
+    for (size_t q = 0; q < batches * INGEST_QUERIES_PER_BATCH; ++q) {
+        long long start = lo->first + static_cast<long long>(randomAt(seed, q) % range);
+        queries.emplace_back(static_cast<int>(start), static_cast<int>(min<long long>(start + span, INT_MAX)));
+    }
+    return queries;
+}
+
+// Feeds v to the engine batch records at a time, answering the batch's queries after each, and leaves the
+// final sorted order in v. Returns a checksum of every record each query returned.
+inline uint64_t ingestWith(const string& engine, vector<pair<int, int>>& v, size_t batch,
+                           const vector<pair<int, int>>& queries) {
+    auto keyLess = [](const pair<int, int>& rec, int k) { return rec.first < k; };
+    uint64_t checksum = 0;
+    size_t q = 0;
+
+    if (engine == "Sorted Run Log") {
+        SortedRunLog<pair<int, int>> log;
+        vector<pair<int, int>> result;
+        for (size_t done = 0; done < v.size(); done += batch) {
+            log.append(v.begin() + done, v.begin() + min(v.size(), done + batch));
+            for (size_t i = 0; i < INGEST_QUERIES_PER_BATCH; ++i, ++q) {
+                result.clear();
+                log.range(queries[q].first, queries[q].second, back_inserter(result));
+                for (const auto& rec : result) checksum += static_cast<uint64_t>(rec.second) + 1;
             }
+        }
+        log.sorted(v.begin());
+        return checksum;
     }
 
-    StabilityResult result;
-    result.stable = (total == preserved);
-    result.ratio = (total > 0 ? static_cast<double>(preserved) / total : 1.0);
-    return result;
+    // Re-sort: the ingested prefix of v is sorted again after every batch, then queried in place
+    for (size_t done = 0; done < v.size(); done += batch) {
+        auto end = v.begin() + min(v.size(), done + batch);
+        if (engine == "Re-sort (Tim Sort)") TimSort(v.begin(), end);
+        else IntroSort(v.begin(), end);
+        for (size_t i = 0; i < INGEST_QUERIES_PER_BATCH; ++i, ++q) {
+            auto first = lower_bound(v.begin(), end, queries[q].first, keyLess);
+            auto last = lower_bound(first, end, queries[q].second, keyLess);
+            for (auto it = first; it != last; ++it) checksum += static_cast<uint64_t>(it->second) + 1;
+        }
+    }
+    return checksum;
 }
 
-// Run stability test multiple times
-inline void runStabilityTest(const string& name, function<void(vector<pair<int, int>>&)> sortFunc, const vector<int>& input, int trials = 10) {
-    double totalRatio = 0.0;
-    bool allStable = true;
+// One engine ingesting the input in batches with queries in between. Writes a row named
+// "<engine> (batch <n>)"; returns the median time.
+inline double runIngestExperiment(const string& engine, size_t batch, const vector<pair<int, int>>& input,
+                                  const string& inputType, int size, uint64_t seed) {
+    size_t batches = (input.size() + batch - 1) / batch;
+    vector<pair<int, int>> queries = ingestQueries(input, batches, seed);
 
-    for (int t = 0; t < trials; ++t) {
-        vector<pair<int, int>> data;
-        for (size_t i = 0; i < input.size(); ++i)
-            data.emplace_back(input[i], i); // Second = unique ID
+    // Reference checksum: records are (key, input position), so query q sees the records before its batch's end
+    vector<pair<int, int>> byKey = input;
+    stable_sort(byKey.begin(), byKey.end(), [](const pair<int, int>& a, const pair<int, int>& b) { return a.first < b.first; });
+    uint64_t expected = 0;
+    for (size_t q = 0; q < queries.size(); ++q) {
+        size_t ingested = min(input.size(), (q / INGEST_QUERIES_PER_BATCH + 1) * batch);
+        auto keyLess = [](const pair<int, int>& rec, int k) { return rec.first < k; };
+        auto first = lower_bound(byKey.begin(), byKey.end(), queries[q].first, keyLess);
+        auto last = lower_bound(first, byKey.end(), queries[q].second, keyLess);
+        for (auto it = first; it != last; ++it)
+            if (static_cast<size_t>(it->second) < ingested) expected += static_cast<uint64_t>(it->second) + 1;
+    }
+
+    uint64_t checksum = 0;
+    auto ingest = [&](vector<pair<int, int>>& v) { checksum = ingestWith(engine, v, batch, queries); };
+    auto bench = runBenchmark(ingest, input);
+    const BenchmarkStats& t = bench.time;
+
+    VerifyResult verify = verifySortedOutput(bench.output, multisetHash(input));
+    verify.sorted = verify.sorted && checksum == expected;
+
+    string name = engine + " (batch " + to_string(batch) + ")";
+    cout << "\n[" << name << ", " << batches << " batches, " << queries.size() << " queries]\n";
+    cout << "Median Time: " << t.median << " sec (" << t.runs << " runs, min " << t.min << ", "
+         << input.size() / t.median / 1e6 << " M records/s)\n";
+    printAllocationStats(bench.heap);
+    cout << "Result: " << sortStatusOf(verify) << (checksum == expected ? "" : " (query results differ)") << ", "
+         << (verify.stable() ? "stable" : "not stable") << "\n";
+
+    ResultRow row = benchmarkRow(name, size, inputType, seed, sizeof(pair<int, int>), bench, verify);
+    row.set("Stability", verify.stable() ? "Stable" : "Not Stable");
+    row.set("StablePercent", verify.stablePercent());
+    resultWriter().write(row);
+    return t.median;
+}
+
+// ------------------------------
+// Auto Sort Tuning
+// ------------------------------
+// Re-measures the AutoSortProfile thresholds on this machine. Each threshold splits one feature of the
+// input shape; its sweep times the engine AutoSort picks on one side against the best alternative over a
+// ladder of inputs at every size, and the threshold goes where the pooled points lose the least time.
+
+// One tuning input: the feature its threshold is compared with, and the swept engine's time over the best
+// alternative's (below 1 where the engine wins)
+struct TuningPoint {
+    double feature;
+    double timeRatio;
+};
+
+// Median time of one of AutoSort's engines on input
+inline double timeAutoSortEngine(const string& engine, const vector<pair<int, int>>& input) {
+    auto sortWith = [&](vector<pair<int, int>>& v) {
+        if (engine == "Tim Sort") {
+            TimSort(v.begin(), v.end());
+        } else if (engine == "LSD Radix Sort") {
+            LSDRadixSort(v.begin(), v.end());
+        } else if (engine == "Counting Sort") {
+            KeyRangeProfile range = probeKeyRange(v.begin(), v.end(), FirstKey{});
+            CountingSort(v.begin(), v.end(), static_cast<int>(range.minKey), range.range, FirstKey{});
+        } else {
+            IntroSort(v.begin(), v.end());
+        }
+    };
+    return runBenchmark(sortWith, input).time.median;
+}
+
+// Times engine and each of rivals on input, prints the line and returns the point at feature
+inline TuningPoint tunePoint(const string& sweep, double feature, const string& engine, const vector<string>& rivals,
+                             const vector<pair<int, int>>& input) {
+    double engineTime = timeAutoSortEngine(engine, input);
+    string bestRival;
+    double rivalTime = 0;
+    for (const string& rival : rivals) {
+        double t = timeAutoSortEngine(rival, input);
+        if (bestRival.empty() || t < rivalTime) bestRival = rival, rivalTime = t;
+    }
+    cout << "  " << sweep << " n=" << input.size() << " feature=" << feature << ": " << engine << " " << engineTime
+         << " s, " << bestRival << " " << rivalTime << " s -> " << (engineTime <= rivalTime ? engine : bestRival) << "\n";
+    return {feature, engineTime / rivalTime};
+}
 
-        StabilityResult result = checkStability(sortFunc, data);
-        totalRatio += result.ratio;
-        if (!result.stable) allStable = false;
+// Threshold with the least summed cost over the points, where a point costs its timeRatio if the engine
+// takes it (feature <= threshold) and 1 if the alternative does. Candidates sit halfway between adjacent
+// features, at the largest feature, and at `never` (below every feature), so one noisy point moves it
+// only as far as its own cost.
+inline double tuningBoundary(vector<TuningPoint> points, double never) {
+    sort(points.begin(), points.end(), [](const TuningPoint& a, const TuningPoint& b) { return a.feature < b.feature; });
+    double best = never, bestCost = points.size(), cost = points.size();
+    for (size_t i = 0; i < points.size(); ++i) {
+        cost += points[i].timeRatio - 1;
+        if (i + 1 < points.size() && points[i + 1].feature == points[i].feature) continue;
+        double threshold = i + 1 < points.size() ? (points[i].feature + points[i + 1].feature) / 2 : points[i].feature;
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = threshold;
+        }
     }
+    return best;
+}
 
-    double avgRatio = totalRatio / trials;
-    cout << "Stability: " << (allStable ? "Stable" : "Not Stable") << " (" << avgRatio * 100 << "%)\n";
+// One selected input's engine times, kept until the thresholds it is compared against are known
+struct TuningInput {
+    string name;
+    size_t n;
+    InputShape shape;
+    double rangeRatio; // Exact key range / n, or -1 if too wide to count
+    double tim, intro, radix, counting; // Median times; counting is 0 when the range is too wide
+};
 
-    csvOut << name << "," << input.size() << "," << "StabilityTest" << "," 
-           << "-,-,-,-,-,-," << (allStable ? "Stable" : "Not Stable") << "," << avgRatio * 100 << "\n";
+// Times AutoSort's engines on one generated input of the benchmark matrix
+inline TuningInput timeTuningInput(const string& name, const vector<pair<int, int>>& input) {
+    TuningInput t{name, input.size(), probeInputShape(input.begin(), input.end(), FirstKey{}), -1, 0, 0, 0, 0};
+    KeyRangeProfile range = probeKeyRange(input.begin(), input.end(), FirstKey{});
+    if (range.range <= COUNTING_SORT_MAX_RANGE) {
+        t.rangeRatio = static_cast<double>(range.range) / input.size();
+        t.counting = timeAutoSortEngine("Counting Sort", input);
+    }
+    t.tim = timeAutoSortEngine("Tim Sort", input);
+    t.intro = timeAutoSortEngine("Intro Sort", input);
+    t.radix = timeAutoSortEngine("LSD Radix Sort", input);
+    cout << "  " << name << " n=" << input.size() << ": Tim Sort " << t.tim << " s, Intro Sort " << t.intro
+         << " s, LSD Radix Sort " << t.radix << " s";
+    if (t.counting > 0) cout << ", Counting Sort " << t.counting << " s";
+    cout << "\n";
+    return t;
 }
 
-// Generate input with many duplicates
-inline vector<int> generateDuplicateRichInput(int size, int mod = 10) {
-    vector<pair<int, int>> pairs;
-    for (int i = 0; i < size; ++i)
-        pairs.emplace_back(i % mod, i);
-    random_shuffle(pairs.begin(), pairs.end());
+// Runs the four sweeps at each size AutoSort probes (>= AUTO_SORT_MIN_PROBE), then times the engines on
+// every selected input type at those sizes, and fills in the profile. A selected input adds a point to
+// each sweep whose branch AutoSort would reach for it with the thresholds decided before that branch, so
+// the profile fits the distributions actually benchmarked as well as the ladders.
+// On failure returns false and sets error.
+inline bool tuneAutoSort(const vector<int>& sizes, const vector<string>& inputTypes, uint64_t seed,
+                         AutoSortProfile& profile, string& error) {
+    vector<int> tuned;
+    for (int n : sizes)
+        if (static_cast<size_t>(n) >= AUTO_SORT_MIN_PROBE) tuned.push_back(n);
+    sort(tuned.begin(), tuned.end());
+    tuned.erase(unique(tuned.begin(), tuned.end()), tuned.end());
+    if (tuned.empty()) {
+        error = "--tune needs a size of at least " + to_string(AUTO_SORT_MIN_PROBE);
+        return false;
+    }
+
+    // Features the engine wins at from above are swept negated, so every boundary is "feature <= threshold"
+    vector<TuningPoint> runs, ranges, repeats, sizesSwept;
+    for (int n : tuned) {
+        cout << "\n[Auto Sort tuning, n=" << n << "]\n";
 
-    vector<int> result;
-    for (auto& [val, _] : pairs)
-        result.push_back(val);
-    return result;
+        // Run structure: Tim Sort against the rest as random swaps break up 0..n-1
+        for (double swapShare : {0.0, 0.0001, 0.0005, 0.002, 0.01, 0.05, 0.2}) {
+            string spec = "NearlySorted:" + to_string(static_cast<size_t>(swapShare * n));
+            auto input = generateRecords(findInputDistribution(spec), n, seed);
+            double rate = probeInputShape(input.begin(), input.end(), FirstKey{}).descentRate;
+            runs.push_back(tunePoint("runs", rate, "Tim Sort", {"Intro Sort", "LSD Radix Sort", "Counting Sort"}, input));
+        }
+
+        // Key range: counting sort against the comparison and radix sorts as the range grows past n
+        for (double ratio : {1.0 / 64, 1.0 / 16, 0.25, 1.0, 4.0, 16.0, 64.0}) {
+            uint64_t range = max<uint64_t>(1, static_cast<uint64_t>(ratio * n));
+            if (range > COUNTING_SORT_MAX_RANGE) continue;
+            vector<pair<int, int>> input(n);
+            for (int i = 0; i < n; ++i) input[i] = {static_cast<int>(randomAt(seed, i) % range), i};
+            ranges.push_back(tunePoint("range", ratio, "Counting Sort", {"Intro Sort", "LSD Radix Sort"}, input));
+        }
+
+        // Repeats: widely spaced keys (too wide to count), fewer and fewer of them, for Intro Sort's partitioning
+        for (double distinctShare : {1.0, 0.25, 1.0 / 16, 1.0 / 256, 64.0 / n, 8.0 / n, 2.0 / n}) {
+            size_t distinct = max<size_t>(2, static_cast<size_t>(distinctShare * n));
+            auto input = generateRecords(findInputDistribution("FewUnique:" + to_string(distinct)), n, seed);
+            double dup = probeInputShape(input.begin(), input.end(), FirstKey{}).duplicateRatio;
+            TuningPoint point = tunePoint("repeats", dup, "Intro Sort", {"LSD Radix Sort"}, input);
+            repeats.push_back({-dup, point.timeRatio});
+        }
+
+        // Size: LSD radix sort against Intro Sort on random 31-bit keys
+        vector<pair<int, int>> input(n);
+        for (int i = 0; i < n; ++i) input[i] = {static_cast<int>(randomAt(seed, i) >> 33), i};
+        TuningPoint point = tunePoint("size", n, "LSD Radix Sort", {"Intro Sort"}, input);
+        sizesSwept.push_back({-static_cast<double>(n), point.timeRatio});
+    }
+
+    vector<TuningInput> selected;
+    for (int n : tuned) {
+        cout << "\n[Auto Sort tuning, selected inputs, n=" << n << "]\n";
+        for (const string& type : inputTypes)
+            selected.push_back(timeTuningInput(type, generateRecords(findInputDistribution(type), n, seed)));
+    }
+
+    // Ascending inputs test the run threshold: Tim Sort against the best of the rest
+    for (const TuningInput& t : selected) {
+        if (t.shape.descentRate > t.shape.ascentRate) continue;
+        double rival = min(t.intro, t.radix);
+        if (t.counting > 0) rival = min(rival, t.counting);
+        runs.push_back({t.shape.descentRate, t.tim / rival});
+    }
+    profile.runDescentRate = tuningBoundary(runs, 0);
+
+    // Inputs past the run branch with a countable range test the range threshold
+    auto pastRuns = [&](const TuningInput& t) {
+        return t.shape.descentRate > profile.runDescentRate && t.shape.ascentRate > profile.runDescentRate;
+    };
+    for (const TuningInput& t : selected)
+        if (pastRuns(t) && t.counting > 0) ranges.push_back({t.rangeRatio, t.counting / min(t.intro, t.radix)});
+    profile.countingRangeRatio = tuningBoundary(ranges, 0);
+
+    // Past counting, repeated keys pick Intro Sort over radix; the rest fall to the size threshold
+    auto pastCounting = [&](const TuningInput& t) {
+        return pastRuns(t) && !(t.counting > 0 && t.rangeRatio <= profile.countingRangeRatio);
+    };
+    for (const TuningInput& t : selected)
+        if (pastCounting(t)) repeats.push_back({-t.shape.duplicateRatio, t.intro / t.radix});
+    profile.duplicateRatio = -tuningBoundary(repeats, -2);
+    for (const TuningInput& t : selected)
+        if (pastCounting(t) && t.shape.duplicateRatio < profile.duplicateRatio)
+            sizesSwept.push_back({-static_cast<double>(t.n), t.radix / t.intro});
+    double radixBoundary = -tuningBoundary(sizesSwept, 1);
+    profile.radixMinSize = radixBoundary < 0 ? numeric_limits<size_t>::max() : static_cast<size_t>(radixBoundary);
+
+    cout << "\nAuto Sort profile: runDescentRate=" << profile.runDescentRate
+         << ", countingRangeRatio=" << profile.countingRangeRatio << ", duplicateRatio=" << profile.duplicateRatio
+         << ", radixMinSize=" << profile.radixMinSize << "\n";
+    return true;
 }
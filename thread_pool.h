@@ -0,0 +1,167 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cpu_affinity.h"
+
+using namespace std;
+
+// ------------------------------
+// Thread Pool
+// ------------------------------
+class ThreadPool {
+public:
+    // With firstCpu >= 0, worker i is pinned to the (i + 1)th allowed CPU after firstCpu (the caller is on firstCpu).
+    // Otherwise workers may run anywhere, even if the creating thread is pinned.
+    explicit ThreadPool(unsigned threads, int firstCpu = -1) {
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back([this, i, firstCpu] {
+                if (firstCpu >= 0) pinCurrentThreadToCpu(allowedCpuAfter(firstCpu, 1 + i));
+                else unpinCurrentThread();
+                workerLoop();
+            });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(m);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    void submit(function<void()> task) {
+        {
+            lock_guard<mutex> lock(m);
+            tasks.push_back(std::move(task));
+        }
+        cv.notify_one();
+    }
+
+    // Runs one queued task on the calling thread; returns false if the queue was empty.
+    // Lets a thread that waits on subtasks help out instead of blocking a worker.
+    bool runPendingTask() {
+        function<void()> task;
+        {
+            lock_guard<mutex> lock(m);
+            if (tasks.empty()) return false;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+        return true;
+    }
+
+private:
+    void workerLoop() {
+        while (true) {
+            function<void()> task;
+            {
+                unique_lock<mutex> lock(m);
+                cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    vector<thread> workers;
+    deque<function<void()>> tasks;
+    mutex m;
+    condition_variable cv;
+    bool stopping = false;
+};
+
+// Fork-join helper: run() spawns subtasks on the pool, wait() helps execute queued work until they finish
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+    ~TaskGroup() { wait(); }
+
+    void run(function<void()> task) {
+        pending.fetch_add(1, memory_order_relaxed);
+        pool.submit([this, task = std::move(task)] {
+            task();
+            pending.fetch_sub(1, memory_order_release);
+        });
+    }
+
+    void wait() {
+        while (pending.load(memory_order_acquire) > 0) {
+            if (!pool.runPendingTask()) this_thread::yield();
+        }
+    }
+
+private:
+    ThreadPool& pool;
+    atomic<int> pending{0};
+};
+
+// ------------------------------
+// Parallel Sort Configuration
+// ------------------------------
+inline unsigned& parallelSortThreadSetting() {
+    static unsigned threads = static_cast<unsigned>(allowedCpus().size());
+    return threads;
+}
+
+// Number of threads the parallel sorts use (including the calling thread)
+inline unsigned parallelSortThreads() { return parallelSortThreadSetting(); }
+
+// CPU the calling thread is pinned to; pool workers take the allowed CPUs after it. -1 = no pinning
+inline int& parallelSortPinSetting() {
+    static int firstCpu = -1;
+    return firstCpu;
+}
+
+// Shared pool with parallelSortThreads() - 1 workers; the calling thread is the remaining one
+inline ThreadPool& parallelSortPool() {
+    static unique_ptr<ThreadPool> pool;
+    static unsigned poolThreads = 0;
+    static int poolFirstCpu = -1;
+    if (!pool || poolThreads != parallelSortThreads() || poolFirstCpu != parallelSortPinSetting()) {
+        pool.reset();
+        poolThreads = parallelSortThreads();
+        poolFirstCpu = parallelSortPinSetting();
+        pool = make_unique<ThreadPool>(poolThreads - 1, poolFirstCpu);
+    }
+    return *pool;
+}
+
+inline void setParallelSortThreads(unsigned threads) {
+    parallelSortThreadSetting() = max(1u, threads);
+}
+
+// Pins the calling thread to firstCpu and the pool workers to the allowed CPUs after it; -1 unpins everything
+inline void setParallelSortPinning(int firstCpu) {
+    parallelSortPinSetting() = firstCpu;
+    if (firstCpu >= 0) pinCurrentThreadToCpu(firstCpu);
+    else unpinCurrentThread();
+}
+
+// Runs body(i) for i in [0, count) across the pool
+template <typename Body>
+void parallelFor(size_t count, Body body) {
+    if (count == 0) return;
+    TaskGroup group(parallelSortPool());
+    for (size_t i = 1; i < count; ++i)
+        group.run([&body, i] { body(i); });
+    body(0);
+    group.wait();
+}
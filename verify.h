@@ -0,0 +1,104 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+using namespace std;
+
+// ------------------------------
+// Multiset Hash
+// ------------------------------
+// Order-independent fingerprint of a set of (value, id) records: two commutative sums of a 64-bit mix,
+// so equal multisets always match and a lost, duplicated or altered record shows up with near certainty
+struct MultisetHash {
+    uint64_t sum = 0;
+    uint64_t sumOfSquares = 0;
+
+    void add(const pair<int, int>& rec) {
+        // splitmix64 finalizer over the packed record
+        uint64_t h = (static_cast<uint64_t>(static_cast<uint32_t>(rec.first)) << 32) | static_cast<uint32_t>(rec.second);
+        h += 0x9e3779b97f4a7c15ULL;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        sum += h;
+        sumOfSquares += h * h;
+    }
+
+    bool operator==(const MultisetHash& other) const {
+        return sum == other.sum && sumOfSquares == other.sumOfSquares;
+    }
+};
+
+// One streaming pass, so a mapped file need not be copied into memory first
+template <typename InputIt>
+MultisetHash multisetHash(InputIt first, InputIt last) {
+    MultisetHash hash;
+    for (; first != last; ++first) hash.add(*first);
+    return hash;
+}
+
+inline MultisetHash multisetHash(const vector<pair<int, int>>& records) {
+    return multisetHash(records.begin(), records.end());
+}
+
+// ------------------------------
+// Output Verification
+// ------------------------------
+struct VerifyResult {
+    bool sorted = true;        // Keys never decrease
+    bool permutation = true;   // Same multiset of records as the input
+    size_t equalPairs = 0;     // Adjacent pairs with equal keys
+    size_t orderedPairs = 0;   // ... of which keep their ids increasing
+
+    bool stable() const { return orderedPairs == equalPairs; }
+    double stablePercent() const { return equalPairs ? 100.0 * orderedPairs / equalPairs : 100.0; }
+};
+
+// Streaming form of the check below, for outputs that are never in memory at once (external sort)
+class OutputChecker {
+public:
+    void add(const pair<int, int>& cur) {
+        hash.add(cur);
+        if (hasPrev) {
+            if (cur.first < prev.first) result.sorted = false;
+            if (cur.first == prev.first) {
+                ++result.equalPairs;
+                result.orderedPairs += prev.second < cur.second;
+            }
+        }
+        prev = cur;
+        hasPrev = true;
+    }
+
+    VerifyResult finish(const MultisetHash& inputHash) {
+        result.permutation = hash == inputHash;
+        return result;
+    }
+
+private:
+    VerifyResult result;
+    MultisetHash hash;
+    pair<int, int> prev;
+    bool hasPrev = false;
+};
+
+// One pass over a sort's output. Ids must be the records' input positions, so a stable sort leaves
+// them increasing within every run of equal keys and adjacent pairs are enough to check stability.
+template <typename InputIt>
+VerifyResult verifySortedOutput(InputIt first, InputIt last, const MultisetHash& inputHash) {
+    OutputChecker checker;
+    for (; first != last; ++first) checker.add(*first);
+    return checker.finish(inputHash);
+}
+
+inline VerifyResult verifySortedOutput(const vector<pair<int, int>>& output, const MultisetHash& inputHash) {
+    return verifySortedOutput(output.begin(), output.end(), inputHash);
+}
+
+// SortStatus cell for a verification result
+inline const char* sortStatusOf(const VerifyResult& result) {
+    if (!result.permutation) return "Corrupted";
+    return result.sorted ? "Sorted" : "Sort Failed";
+}